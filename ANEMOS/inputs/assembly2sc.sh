@@ -12,4 +12,4 @@ cd ..
 build/pim-cores $1
 cd inputs
 
-# ./decode_results results/$1.results
+# bin/decode_results results/$1.results0
@@ -1,85 +1,100 @@
 #include <cstdio>
 #include <cstdlib>
 #include <stdlib.h>
+#include <string.h>
 #include <iostream>
-#include <sstream>
 #include <iomanip>
 #include <fstream>
 #include <string>
+#include <vector>
 
 #include "half.hpp"
 #include "datatypes.h"
 #include "../../src/defs.h"
+#include "../../src/tb/cnm_logger.h"
 
 using namespace std;
 
 #define HALF_MASK ((1 << 16) - 1)
 #if WORD_BITS != 64
     #define MASK ((1ul << WORD_BITS) - 1)
-#else 
+#else
     #define MASK 0xFFFFFFFFFFFFFFFF
 #endif
 
-int main(int argc, const char *argv[])
-{
-    if (argc != 2) {
-        cout << "Usage: " << argv[0] << " <results-file>" << endl;
-        return 0;
-    }
-
-    string ri = argv[1];    // Input results file name
-    string riline;
-    string cycle, address;
-    dq_type dataAux;
+// Prints the values packed in a 64-bit word of the bank buses
+void print_word(uint64_t dataAux) {
     half_float::half half_aux;
     #if !(HALF_FLOAT)
     #if INT_TYPE
         cnm_t temp_aux;
-    #else 
+    #else
         cnm_union temp_aux;
     #endif
     #endif
 
-    // Open input file
-    ifstream results;
-    results.open(ri);
-
-    while (getline(results, riline)) {
+    for (int i = 0; i < (DQ_BITS/WORD_BITS); i++) {
+        #if HALF_FLOAT
+            half_aux = half_float::half(half_float::detail::binary, dataAux & HALF_MASK);
+            cout << half_aux << " ";
+        #elif INT_TYPE
+            temp_aux = (dataAux & MASK);
+            cout << (int64_t)temp_aux << " ";
+        #else
+            temp_aux.bin = (dataAux & MASK);
+            cout << temp_aux.data << " ";
+        #endif
+        dataAux = dataAux >> WORD_BITS;
+    }
+}
 
-        istringstream riiss(riline);
+int main(int argc, const char *argv[])
+{
+    bool raw = (argc == 3 && !strcmp(argv[1], "-x"));
+    if (argc != 2 && !raw) {
+        cout << "Usage: " << argv[0] << " [-x] <results-file>" << endl;
+        cout << "  -x  Print the data as raw hexadecimal words" << endl;
+        return 0;
+    }
 
-        riiss >> cycle >> address;
-        cout << cycle << " " << address << "\t";
-        #if HALF_FLOAT
-                while (riiss >> showbase >> hex >> dataAux) {
-                    for (int i=0; DQ_BITS/WORD_BITS; i++) {
-                        half_aux = half_float::half(half_float::detail::binary, dataAux & HALF_MASK);
-                        cout << half_aux << " ";
-                        dataAux = dataAux >> 16;
-                    }
-                    cout << "\t";
-                }
+    string ri = argv[argc-1];   // Input results file name
+    cnm_log_header header;
 
-                cout << endl;
-            
-        #else
-                while (riiss >> showbase >> hex >> dataAux) {
-                    for (int i=0; i<(DQ_BITS/WORD_BITS); i++) {
-                        
-                        #if INT_TYPE
-                            temp_aux = (dataAux & MASK);
-                            cout << (int)temp_aux << " ";
-                        #else 
-                            temp_aux.bin = (dataAux & MASK);
-                            cout << temp_aux.data << " ";
-                        #endif
-                        dataAux = dataAux >> WORD_BITS;
-                    }
-                    cout << "\t";
-                }
+    // Open input file
+    ifstream results(ri, ios::binary);
+    if (!results.is_open()) {
+        cout << "Error when opening results file " << ri << endl;
+        return 1;
+    }
+    if (!results.read((char*) &header, sizeof(header)) || header.magic != CNM_LOG_MAGIC) {
+        cout << ri << " is not a results file of the NMC cores" << endl;
+        return 1;
+    }
+    if (header.version != CNM_LOG_VERSION) {
+        cout << "Unsupported results file version " << header.version << endl;
+        return 1;
+    }
+    if (!raw && header.data_type != DATA_TYPE) {
+        cout << "Results file written with DATA_TYPE " << header.data_type << " but decoder built with DATA_TYPE " << DATA_TYPE << endl;
+        return 1;
+    }
 
-                cout << endl;
-            
-        #endif
+    vector<uint64_t> record(2 + header.words_per_record);
+    while (results.read((char*) record.data(), record.size() * sizeof(uint64_t))) {
+        cout << dec << record[0] << " " << showbase << hex << record[1] << dec << "\t";
+        for (uint32_t i = 0; i < header.words_per_record; i++) {
+            if (raw) {
+                cout << showbase << hex << record[2+i] << dec;
+            } else {
+                print_word(record[2+i]);
+            }
+            cout << "\t";
+        }
+        cout << endl;
+    }
+    if (results.gcount() != 0) {
+        cout << "Warning: truncated record at the end of " << ri << endl;
     }
+
+    return 0;
 }
@@ -34,9 +34,11 @@ static vector<int> get_offending_subarray(DRAM<SALP>* channel, vector<int> & add
 
 
 template <>
-vector<int> Controller<SALP>::get_addr_vec(SALP::Command cmd, list<Request>::iterator req){
-    if (cmd == SALP::Command::PRE_OTHER)
-        return get_offending_subarray(channel, req->addr_vec);
+const vector<int>& Controller<SALP>::get_addr_vec(SALP::Command cmd, list<Request>::iterator req){
+    if (cmd == SALP::Command::PRE_OTHER) {
+        cmd_addr_vec = get_offending_subarray(channel, req->addr_vec);
+        return cmd_addr_vec;
+    }
     else
         return req->addr_vec;
 }
@@ -68,7 +70,7 @@ void Controller<TLDRAM>::tick(){
 
     /*** 1. Serve completed reads ***/
     if (pending.size()) {
-        Request& req = pending[0];
+        Request& req = pending.front();
         if (req.depart <= clk) {
           if (req.depart - req.arrive > 1) {
                   read_latency_sum += req.depart - req.arrive;
@@ -76,7 +78,7 @@ void Controller<TLDRAM>::tick(){
                       req.addr_vec.data(), -1, clk);
           }
             req.callback(req);
-            pending.pop_front();
+            request_pool.splice(request_pool.begin(), pending, pending.begin());
         }
     }
 
@@ -161,14 +163,15 @@ void Controller<TLDRAM>::tick(){
     // set a future completion time for read requests
     if (req->type == Request::Type::READ || req->type == Request::Type::EXTENSION) {
         req->depart = clk + channel->spec->read_latency;
-        pending.push_back(*req);
+        pending.splice(pending.end(), queue->q, req);
+        return;
     }
     if (req->type == Request::Type::WRITE) {
         channel->update_serving_requests(req->addr_vec.data(), -1, clk);
     }
 
     // remove request from queue
-    queue->q.erase(req);
+    release_request(queue->q, req);
 }
 
 template<>
@@ -25,6 +25,7 @@
 #include <cmath>
 #include <cassert>
 #include <tuple>
+#include <algorithm>
 
 using namespace std;
 
@@ -41,9 +42,17 @@ public:
     virtual ~MemoryBase() {}
     virtual double clk_ns() = 0;
     virtual void tick() = 0;
-    virtual bool send(Request req) = 0;
+    virtual bool send(Request& req) = 0;
     virtual int pending_requests() = 0;
     virtual void finish(void) = 0;
+    virtual unsigned int rdqueuesize(void) = 0;
+    virtual unsigned int wrqueuesize(void) = 0;
+    virtual int num_channels(void) = 0;
+    virtual int channel(long addr) = 0;
+    virtual unsigned int rdqueuesize(int channel) = 0;
+    virtual unsigned int wrqueuesize(int channel) = 0;
+    virtual long atomic_latency(long addr, bool write, long clk) = 0;
+    virtual bool atomic_mode_change(long addr) = 0;
     virtual long page_allocator(long addr, int coreid) = 0;
     virtual void record_core(int coreid) = 0;
     virtual void set_high_writeq_watermark(const float watermark) = 0;
@@ -79,6 +88,25 @@ protected:
 
   long max_address;
   MapScheme mapping_scheme;
+
+  // Analytic model of the atomic accesses, see atomic_latency
+  vector<int> atomic_open_row;      // open row of every bank, -1 if closed
+  vector<long> atomic_bank_ready;   // clock at which every bank is done with its last access
+  vector<long> atomic_bus_ready;    // clock at which the data bus of every channel is free
+  int atomic_nRCD[2] = {0, 0};      // ACT to RD and ACT to WR
+  int atomic_nRP = 0;
+  vector<int> atomic_addr_vec;
+
+  vector<int> channel_addr_vec;     // scratch address of channel()
+
+  // Cycles of each channel ticked on its own, see tick_channel
+  struct ChannelTicks {
+    long cycles = 0;
+    long reads = 0, writes = 0;
+    long req_num_sum = 0, read_req_num_sum = 0, write_req_num_sum = 0;
+    vector<pair<long, long>> active;  // [begin, end) of the cycles in which the channel served requests
+  };
+  vector<ChannelTicks> channel_ticks;
   
 public:
     enum class Type {
@@ -162,6 +190,8 @@ public:
           free_physical_pages.resize(free_physical_pages_remaining, -1);
         }
 
+        channel_ticks.resize(ctrls.size());
+
         dram_capacity
             .name("dram_capacity")
             .desc("Number of bytes in simulated DRAM")
@@ -310,34 +340,118 @@ public:
         }
     }
 
-    bool send(Request req)
+    // Channels are independent between requests, so they can be ticked on
+    // different threads with send_channel and tick_channel, as long as each
+    // channel is only used by one thread. The stats of the memory are then
+    // added by merge_channel_ticks once all the channels are at the same cycle.
+    bool send_channel(Request& req)
     {
-        req.addr_vec.resize(addr_bits.size());
-        long addr = req.addr;
-        int coreid = req.coreid;
+        map_address(req.addr, req.addr_vec);
+        int ch = req.addr_vec[int(T::Level::Channel)];
+        if (!ctrls[ch]->enqueue(req))
+            return false;
+        if (req.type == Request::Type::READ)
+            channel_ticks[ch].reads++;
+        else if (req.type == Request::Type::WRITE)
+            channel_ticks[ch].writes++;
+        return true;
+    }
+
+    void tick_channel(int ch)
+    {
+        Controller<T>* ctrl = ctrls[ch];
+        ChannelTicks& t = channel_ticks[ch];
+        t.req_num_sum += ctrl->readq.size() + ctrl->writeq.size() + ctrl->pending.size();
+        t.read_req_num_sum += ctrl->readq.size() + ctrl->pending.size();
+        t.write_req_num_sum += ctrl->writeq.size();
+        if (ctrl->is_active()) {
+            if (!t.active.empty() && t.active.back().second == t.cycles)
+                t.active.back().second++;
+            else
+                t.active.push_back(make_pair(t.cycles, t.cycles + 1));
+        }
+        ctrl->tick();
+        t.cycles++;
+    }
+
+    long channel_cycles(int ch)
+    {
+        return channel_ticks[ch].cycles;
+    }
+
+    int pending_requests(int ch)
+    {
+        Controller<T>* ctrl = ctrls[ch];
+        return ctrl->readq.size() + ctrl->writeq.size() + ctrl->otherq.size() + ctrl->actq.size() + ctrl->pending.size();
+    }
+
+    void merge_channel_ticks()
+    {
+        long cycles = channel_ticks[0].cycles;
+        vector<pair<long, long>> active;
+        for (unsigned int ch = 0; ch < ctrls.size(); ch++) {
+            ChannelTicks& t = channel_ticks[ch];
+            assert(t.cycles == cycles);
+            num_incoming_requests += t.reads + t.writes;
+            num_read_requests[0] += t.reads;  // DRAM traces come from a single core
+            num_write_requests[0] += t.writes;
+            incoming_read_reqs_per_channel[ch] += t.reads;
+            incoming_requests_per_channel[ch] += t.reads + t.writes;
+            in_queue_req_num_sum += t.req_num_sum;
+            in_queue_read_req_num_sum += t.read_req_num_sum;
+            in_queue_write_req_num_sum += t.write_req_num_sum;
+            active.insert(active.end(), t.active.begin(), t.active.end());
+            t = ChannelTicks();
+        }
+        num_dram_cycles += cycles;
+
+        // cycles in which any channel served requests
+        sort(active.begin(), active.end());
+        long end = 0;
+        for (auto& interval : active) {
+            if (interval.second > end) {
+                ramulator_active_cycles += interval.second - max(interval.first, end);
+                end = interval.second;
+            }
+        }
+    }
+
+    // Splits the address in the index of each level, as done for the requests
+    void map_address(long addr, vector<int>& addr_vec)
+    {
+        addr_vec.resize(addr_bits.size());
 
         // Each transaction size is 2^tx_bits, so first clear the lowest tx_bits bits
         clear_lower_bits(addr, tx_bits);
 
         if (use_mapping_file){
-            apply_mapping(addr, req.addr_vec);
+            apply_mapping(addr, addr_vec);
         }
         else {
             switch(int(type)){
                 case int(Type::ChRaBaRoCo):
                     for (int i = addr_bits.size() - 1; i >= 0; i--)
-                        req.addr_vec[i] = slice_lower_bits(addr, addr_bits[i]);
+                        addr_vec[i] = slice_lower_bits(addr, addr_bits[i]);
                     break;
                 case int(Type::RoBaRaCoCh):
-                    req.addr_vec[0] = slice_lower_bits(addr, addr_bits[0]);
-                    req.addr_vec[addr_bits.size() - 1] = slice_lower_bits(addr, addr_bits[addr_bits.size() - 1]);
+                    addr_vec[0] = slice_lower_bits(addr, addr_bits[0]);
+                    addr_vec[addr_bits.size() - 1] = slice_lower_bits(addr, addr_bits[addr_bits.size() - 1]);
                     for (int i = 1; i <= int(T::Level::Row); i++)
-                        req.addr_vec[i] = slice_lower_bits(addr, addr_bits[i]);
+                        addr_vec[i] = slice_lower_bits(addr, addr_bits[i]);
                     break;
                 default:
                     assert(false);
             }
         }
+    }
+
+    // Maps the address of the request into its addr_vec, which is left set
+    // whether or not the request is accepted, addr_vec[0] being its channel
+    bool send(Request& req)
+    {
+        int coreid = req.coreid;
+
+        map_address(req.addr, req.addr_vec);
 
         if(ctrls[req.addr_vec[0]]->enqueue(req)) {
             // tally stats here to avoid double counting for requests that aren't enqueued
@@ -522,9 +636,79 @@ public:
       }
 
       // finalize average queueing requests
-      in_queue_req_num_avg = in_queue_req_num_sum.value() / dram_cycles;
-      in_queue_read_req_num_avg = in_queue_read_req_num_sum.value() / dram_cycles;
-      in_queue_write_req_num_avg = in_queue_write_req_num_sum.value() / dram_cycles;
+      if (dram_cycles) {
+        in_queue_req_num_avg = in_queue_req_num_sum.value() / dram_cycles;
+        in_queue_read_req_num_avg = in_queue_read_req_num_sum.value() / dram_cycles;
+        in_queue_write_req_num_avg = in_queue_write_req_num_sum.value() / dram_cycles;
+      }
+    }
+
+    unsigned int rdqueuesize() {
+        return ctrls[0]->readq.max;
+    }
+    
+    unsigned int wrqueuesize() {
+        return ctrls[0]->writeq.max;
+    }
+
+    int num_channels() {
+        return ctrls.size();
+    }
+
+    // Channel the request to the address is sent to
+    int channel(long addr) {
+        map_address(addr, channel_addr_vec);
+        return channel_addr_vec[int(T::Level::Channel)];
+    }
+
+    unsigned int rdqueuesize(int channel) {
+        return ctrls[channel]->readq.max;
+    }
+
+    unsigned int wrqueuesize(int channel) {
+        return ctrls[channel]->writeq.max;
+    }
+
+    // Latency in memory cycles of an atomic access issued at clk, used instead
+    // of simulating the controllers while fast-forwarding. Rows are left open
+    // as with the Opened row policy, and an access waits for the previous one
+    // to its bank and for the data bus of its channel, so the latency follows
+    // row hits, misses and conflicts and the bank and channel contention.
+    long atomic_latency(long addr, bool write, long clk) {
+        if (atomic_open_row.empty())
+            init_atomic_model();
+
+        map_address(addr, atomic_addr_vec);
+        int *sz = spec->org_entry.count;
+        long bank = 0;
+        for (int lev = 0; lev < int(T::Level::Row); lev++)
+            bank = bank * sz[lev] + atomic_addr_vec[lev];
+        int row = atomic_addr_vec[int(T::Level::Row)];
+
+        long latency = spec->read_latency;
+        if (atomic_open_row[bank] != row) {
+            latency += atomic_nRCD[write];
+            if (atomic_open_row[bank] != -1)
+                latency += atomic_nRP;
+            atomic_open_row[bank] = row;
+        }
+        long& bus = atomic_bus_ready[atomic_addr_vec[int(T::Level::Channel)]];
+        long done = max(max(clk, atomic_bank_ready[bank]) + latency, bus + spec->speed_entry.nBL);
+        atomic_bank_ready[bank] = done;
+        bus = done;
+        return done - clk;
+    }
+
+    // Follows an atomic access to the mode-change address of a channel, so that
+    // the channel is in the right mode when the controllers are simulated again.
+    // False if addr is not a mode change.
+    bool atomic_mode_change(long addr) {
+        map_address(addr, atomic_addr_vec);
+        Controller<T>* ctrl = ctrls[atomic_addr_vec[int(T::Level::Channel)]];
+        if (!ctrl->nmc_mode_switch || !ctrl->is_mode_change(atomic_addr_vec))
+            return false;
+        ctrl->atomic_mode_change();
+        return true;
     }
 
     long page_allocator(long addr, int coreid) {
@@ -582,6 +766,33 @@ public:
 
 private:
 
+    // Takes the activation and precharge delays from the timing table, so that
+    // the model does not depend on the names of the timings. They are looked
+    // for from the bank up, as AllBanks standards keep them at the rank.
+    void init_atomic_model() {
+        int *sz = spec->org_entry.count;
+        long banks = 1;
+        for (int lev = 0; lev < int(T::Level::Row); lev++)
+            banks *= sz[lev];
+        atomic_open_row.assign(banks, -1);
+        atomic_bank_ready.assign(banks, 0);
+        atomic_bus_ready.assign(sz[int(T::Level::Channel)], 0);
+
+        atomic_nRCD[0] = atomic_timing(T::Command::ACT, T::Command::RD);
+        atomic_nRCD[1] = atomic_timing(T::Command::ACT, T::Command::WR);
+        atomic_nRP = atomic_timing(T::Command::PRE, T::Command::ACT);
+    }
+
+    int atomic_timing(typename T::Command from, typename T::Command to) {
+        for (int lev = int(T::Level::Bank); lev >= 0; lev--) {
+            for (auto& t : spec->timing[lev][int(from)]) {
+                if (t.dist == 1 && t.cmd == to)
+                    return t.val;
+            }
+        }
+        return 0;
+    }
+
     int calc_log2(int val){
         int n = 0;
         while ((val >>= 1))
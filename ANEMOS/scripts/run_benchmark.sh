@@ -0,0 +1,206 @@
+#!/bin/bash
+
+# Simulator-throughput benchmark of the NMC stack.
+#
+# Builds the current src/ in SystemC-only mode (GEM5 0) in a private folder and
+# runs the standard kernels of run_kernels_hbm.sh through the Ramulator + SystemC
+# flow, timing each stage. For every kernel it reports the simulated NMC cycles,
+# the host seconds spent in Ramulator, in SystemC and in IPC with gem5 (NA for
+# the SystemC-only runs), the simulated NMC cycles per host second and the peak
+# RSS of the SystemC model.
+#
+# Runs of the NMClib kernels under gem5 can be added with -g, pointing to the
+# simout of a gem5 run launched with --nmc_host_profile.
+#
+# The results are written as a tab-separated table that can be saved as a
+# baseline (-s) and compared against later (-b). A kernel regresses when its
+# simulated cycles change, its throughput drops or its peak RSS grows by more
+# than the tolerance, and the script then exits with status 1.
+#
+# benchmark_baseline.tsv, next to this script, is the reference for the default
+# kernels. Its simulated cycles hold on any host. Its throughput and peak RSS
+# only hold on a host like the one of its first line, so save a baseline of your
+# own before comparing performance.
+#
+# Needs SYSTEMC_HOME and RAMULATOR_ROOT, as run_sweep.sh.
+
+usage() {
+    echo "Usage: $0 [-k <kernel_list>] [-o <out_dir>] [-g <gem5_simout>]... [-b <baseline>] [-s <baseline>] [-r <tolerance_%>]"
+    echo "  -k  Kernel list, one '<name> <KERNEL> <map_kernel args>' per line (default: run_kernels_hbm.sh kernels)"
+    echo "  -o  Output folder (default: ../benchmark)"
+    echo "  -g  simout of a gem5 run with --nmc_host_profile, can be repeated"
+    echo "  -b  Baseline to compare the results against (reference: $(dirname "$0")/benchmark_baseline.tsv)"
+    echo "  -s  Save the results as a new baseline"
+    echo "  -r  Tolerance in percent for throughput and peak RSS (default: 10)"
+    exit 1
+}
+
+SCRIPT_DIR=$(cd "$(dirname "$0")" && pwd)
+ANEMOS_DIR=$(dirname "$SCRIPT_DIR")
+
+KERNEL_LIST=""
+OUT_DIR="$ANEMOS_DIR/benchmark"
+GEM5_OUTS=()
+BASELINE=""
+SAVE_BASELINE=""
+TOLERANCE=10
+
+while getopts "k:o:g:b:s:r:h" opt; do
+    case $opt in
+        k) KERNEL_LIST=$(cd "$(dirname "$OPTARG")" && pwd)/$(basename "$OPTARG") ;;
+        o) OUT_DIR=$OPTARG ;;
+        g) GEM5_OUTS+=("$OPTARG") ;;
+        b) BASELINE=$OPTARG ;;
+        s) SAVE_BASELINE=$OPTARG ;;
+        r) TOLERANCE=$OPTARG ;;
+        *) usage ;;
+    esac
+done
+
+if [ -z "$SYSTEMC_HOME" ] || [ -z "$RAMULATOR_ROOT" ]; then
+    echo "SYSTEMC_HOME and RAMULATOR_ROOT must be set"
+    exit 1
+fi
+
+mkdir -p "$OUT_DIR"
+OUT_DIR=$(cd "$OUT_DIR" && pwd)
+WORK_DIR="$OUT_DIR/work"
+TABLE="$OUT_DIR/benchmark.tsv"
+CONFIG="$RAMULATOR_ROOT/configs/HBM2_AB-config.cfg"
+
+# Same kernels as run_kernels_hbm.sh
+if [ -z "$KERNEL_LIST" ]; then
+    KERNEL_LIST="$OUT_DIR/kernels.list"
+    cat > "$KERNEL_LIST" << EOF
+ewarwV256n256 EWARW 256 256
+dpV256n256 DP 256 256
+mvm16x16 MMS 1 16 16
+mvm32x32 MMS 1 32 32
+mvm64x64 MMS 1 64 64
+mvm128x128 MMS 1 128 128
+mvm256x256 MMS 1 256 256
+mvm512x512 MMS 1 512 512
+mvm1024x1024 MMS 1 1024 1024
+mmsm128n128q128 MMS 128 128 128
+ccwwri24x24x32o20x20x32k5 CCWWR 32 24 24 5 1 32 20 20
+EOF
+fi
+
+now() {
+    date +%s.%N
+}
+
+# Value printed by the simulators after the given label
+report_value() {
+    grep "$2" "$1" | tail -1 | awk -F': ' '{print $2}'
+}
+
+# Build the NMC cores and the input tools in SystemC-only mode
+rm -rf "$WORK_DIR"
+mkdir -p "$WORK_DIR/build/src/tb" "$WORK_DIR/inputs"
+cp -r "$ANEMOS_DIR/src" "$WORK_DIR/"
+cp "$ANEMOS_DIR"/build/makefile "$ANEMOS_DIR"/build/sources.mk "$WORK_DIR/build/"
+cp "$ANEMOS_DIR"/build/src/subdir.mk "$WORK_DIR/build/src/"
+cp "$ANEMOS_DIR"/build/src/tb/subdir.mk "$WORK_DIR/build/src/tb/"
+cp -r "$ANEMOS_DIR/inputs/src" "$ANEMOS_DIR/inputs/compile_all.sh" "$WORK_DIR/inputs/"
+for d in SystemC address-input assembly-input bin data-input ramulator-in ramulator-out raw results; do
+    mkdir -p "$WORK_DIR/inputs/$d"
+done
+sed -i "s/#define GEM5 .*/#define GEM5        0/g" "$WORK_DIR/src/defs.h"
+
+echo "Building NMC cores"
+if ! make -C "$WORK_DIR/build" all > "$OUT_DIR/build.log" 2>&1 ||
+   ! (cd "$WORK_DIR/inputs" && bash compile_all.sh) >> "$OUT_DIR/build.log" 2>&1; then
+    echo "Build failed, see $OUT_DIR/build.log"
+    exit 1
+fi
+
+printf "kernel\tnmc_cycles\tramulator_seconds\tsystemc_seconds\tipc_seconds\tcycles_per_second\tpeak_rss_kb\n" > "$TABLE"
+
+while read -r name kernel args; do
+    [ -z "$name" ] && continue
+    log="$OUT_DIR/$name.log"
+    echo "Running $name"
+
+    # Kernel mapping and command generation are not part of the measurement
+    (
+        cd "$WORK_DIR/inputs" &&
+        bin/map_kernel "$name" "$kernel" $args &&
+        bin/nmc_assembler assembly-input/$name.asm raw/$name.seq data-input/$name.data address-input/$name.addr &&
+        bin/raw2ramulator raw/$name.seq ramulator-in/$name.trace
+    ) < /dev/null > "$log" 2>&1 || { echo "$name: mapping failed, see $log"; continue; }
+
+    start=$(now)
+    (
+        cd "$WORK_DIR/inputs" &&
+        "$RAMULATOR_ROOT/ramulator" "$CONFIG" --mode=dram --stats "$OUT_DIR/$name.stats" ramulator-in/$name.trace > ramulator-out/$name.cmd
+    ) < /dev/null >> "$log" 2>&1 || { echo "$name: Ramulator failed, see $log"; continue; }
+    ramulator_seconds=$(awk "BEGIN {print $(now) - $start}")
+
+    (
+        cd "$WORK_DIR/inputs" &&
+        bin/ramulator2sc raw/$name.seq ramulator-out/$name.cmd SystemC/$name.sci 1 &&
+        cd .. && build/nmc-cores "$name"
+    ) < /dev/null >> "$log" 2>&1 || { echo "$name: SystemC failed, see $log"; continue; }
+
+    cycles=$(grep "Simulation finished at cycle" "$log" | tail -1 | awk '{print $NF}')
+    systemc_seconds=$(report_value "$log" "^Host seconds:")
+    rss=$(report_value "$log" "^Peak RSS (kB)")
+    # Without gem5 there is no IPC to measure
+    printf "%s\t%s\t%.3f\t%.3f\tNA\t%.0f\t%s\n" "$name" "$cycles" "$ramulator_seconds" "$systemc_seconds" \
+        "$(awk "BEGIN {print $cycles / $systemc_seconds}")" "$rss" >> "$TABLE"
+
+    for d in assembly-input data-input address-input raw ramulator-in ramulator-out SystemC; do
+        rm -f "$WORK_DIR/inputs/$d/$name".*
+    done
+    rm -f "$WORK_DIR/pch_wave.vcd"
+done < "$KERNEL_LIST"
+
+# gem5 runs: the SystemC process reports the time it was blocked on gem5, and
+# NMCcores the time gem5 was blocked on SystemC, which includes the SystemC work
+for simout in "${GEM5_OUTS[@]}"; do
+    cycles=$(grep "Simulation finished at cycle" "$simout" | tail -1 | awk '{print $NF}')
+    sc_total=$(report_value "$simout" "^Host seconds:")
+    sc_wait=$(report_value "$simout" "^Host seconds waiting for gem5")
+    nmc_blocked=$(report_value "$simout" "^NMCcores host seconds blocked on SystemC")
+    ramulator_seconds=$(report_value "$simout" "^Ramulator host seconds")
+    rss=$(report_value "$simout" "^Peak RSS (kB)")
+    if [ -z "$cycles" ] || [ -z "$sc_total" ] || [ -z "$nmc_blocked" ]; then
+        echo "$simout: missing NMC host reports, skipped"
+        continue
+    fi
+    printf "gem5:%s\t%s\t%.3f\t%.3f\t%.3f\t%.0f\t%s\n" "$(basename "$(dirname "$simout")")" "$cycles" "${ramulator_seconds:-0}" \
+        "$(awk "BEGIN {print $sc_total - $sc_wait}")" "$(awk "BEGIN {print $nmc_blocked - ($sc_total - $sc_wait)}")" \
+        "$(awk "BEGIN {print $cycles / $sc_total}")" "$rss" >> "$TABLE"
+done
+
+cat "$TABLE"
+
+if [ -n "$SAVE_BASELINE" ]; then
+    cp "$TABLE" "$SAVE_BASELINE"
+    echo "Baseline saved to $SAVE_BASELINE"
+fi
+
+if [ -n "$BASELINE" ]; then
+    awk -F'\t' -v tol="$TOLERANCE" '
+        /^#/ || $1 == "kernel" { next }
+        NR == FNR { cycles[$1] = $2; cps[$1] = $6; rss[$1] = $7; next }
+        !($1 in cycles) { print $1 ": not in baseline"; next }
+        {
+            if ($2 != cycles[$1]) {
+                print $1 ": simulated cycles changed " cycles[$1] " -> " $2; bad = 1
+            }
+            if ($6 < cps[$1] * (1 - tol / 100)) {
+                print $1 ": throughput dropped " cps[$1] " -> " $6 " cycles/s"; bad = 1
+            }
+            if ($7 > rss[$1] * (1 + tol / 100)) {
+                print $1 ": peak RSS grew " rss[$1] " -> " $7 " kB"; bad = 1
+            }
+        }
+        END { exit bad }' "$BASELINE" "$TABLE"
+    if [ $? -ne 0 ]; then
+        echo "Regressions against $BASELINE"
+        exit 1
+    fi
+    echo "No regressions against $BASELINE"
+fi
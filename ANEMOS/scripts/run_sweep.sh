@@ -0,0 +1,264 @@
+#!/bin/bash
+
+# Parallel design-space exploration of the ANEMOS kernels.
+#
+# Every design point (DRAM standard, CORES_PER_PCH, GRF_ENTRIES, DATA_TYPE) gets
+# its own copy of src/, build/ and inputs/ under the output folder, so defs.h can
+# be configured and the NMC cores and the input tools rebuilt without touching the
+# repository or the other points. Points are run concurrently, and the results of
+# all the kernels are gathered in a single tab-separated table.
+#
+# Needs SYSTEMC_HOME (as for build/makefile) and RAMULATOR_ROOT (as for
+# inputs/assembly2sc.sh), with ramulator built from ramulator_files.
+
+usage() {
+    echo "Usage: $0 [-j <jobs>] [-d <drams>] [-c <cores_per_pch>] [-g <grf_entries>] [-t <data_types>] [-k <kernel_list>] [-o <out_dir>]"
+    echo "  -j  Number of design points simulated concurrently (default: nproc)"
+    echo "  -d  Comma-separated DRAM standards: HBM, DDR4, GDDR5, LPDDR4, PCM, RRAM, STTRAM (default: HBM)"
+    echo "  -c  Comma-separated CORES_PER_PCH values (default: value in defs.h for each DRAM)"
+    echo "  -g  Comma-separated GRF_ENTRIES values (default: value in defs.h)"
+    echo "  -t  Comma-separated DATA_TYPE values, see defs.h (default: value in defs.h)"
+    echo "  -k  Kernel list, one '<name> <KERNEL> <map_kernel args>' per line (default: run_kernels_hbm.sh kernels)"
+    echo "  -o  Output folder (default: ../sweep)"
+    exit 1
+}
+
+SCRIPT_DIR=$(cd "$(dirname "$0")" && pwd)
+ANEMOS_DIR=$(dirname "$SCRIPT_DIR")
+
+JOBS=$(nproc)
+DRAMS="HBM"
+CORES=""
+GRFS=""
+DTYPES=""
+KERNEL_LIST=""
+OUT_DIR="$ANEMOS_DIR/sweep"
+
+while getopts "j:d:c:g:t:k:o:h" opt; do
+    case $opt in
+        j) JOBS=$OPTARG ;;
+        d) DRAMS=$OPTARG ;;
+        c) CORES=$OPTARG ;;
+        g) GRFS=$OPTARG ;;
+        t) DTYPES=$OPTARG ;;
+        k) KERNEL_LIST=$(cd "$(dirname "$OPTARG")" && pwd)/$(basename "$OPTARG") ;;
+        o) OUT_DIR=$OPTARG ;;
+        *) usage ;;
+    esac
+done
+
+if [ -z "$SYSTEMC_HOME" ] || [ -z "$RAMULATOR_ROOT" ]; then
+    echo "SYSTEMC_HOME and RAMULATOR_ROOT must be set"
+    exit 1
+fi
+
+
+mkdir -p "$OUT_DIR/points"
+OUT_DIR=$(cd "$OUT_DIR" && pwd)
+
+# Same kernels as run_kernels_hbm.sh
+if [ -z "$KERNEL_LIST" ]; then
+    KERNEL_LIST="$OUT_DIR/kernels.list"
+    cat > "$KERNEL_LIST" << EOF
+ewarwV256n256 EWARW 256 256
+dpV256n256 DP 256 256
+mvm16x16 MMS 1 16 16
+mvm32x32 MMS 1 32 32
+mvm64x64 MMS 1 64 64
+mvm128x128 MMS 1 128 128
+mvm256x256 MMS 1 256 256
+mvm512x512 MMS 1 512 512
+mvm1024x1024 MMS 1 1024 1024
+mmsm128n128q128 MMS 128 128 128
+ccwwri24x24x32o20x20x32k5 CCWWR 32 24 24 5 1 32 20 20
+EOF
+fi
+
+# Value of DRAM in defs.h and Ramulator configuration for each standard
+dram_index() {
+    case $1 in
+        HBM)    echo 0 ;;
+        DDR4)   echo 1 ;;
+        GDDR5)  echo 2 ;;
+        LPDDR4) echo 3 ;;
+        PCM)    echo 4 ;;
+        RRAM)   echo 5 ;;
+        STTRAM) echo 6 ;;
+        *)      echo "" ;;
+    esac
+}
+
+# Value of a define of defs.h as built for the DRAM with the given index, or
+# the file rewritten with a new value when one is given. Only the branches of
+# the "#if (DRAM ...)" blocks taken for that DRAM are read or changed, as some
+# defines, like CORES_PER_PCH, have one value per DRAM.
+dram_define() {
+    local file=$1 dram=$2 name=$3 value=$4
+    awk -v dram="$dram" -v name="$name" -v value="$value" -v set="${4+1}" '
+        function holds(term,   t) {
+            split(term, t, " ")
+            if (t[1] != "DRAM") return 0
+            if (t[2] == "==") return dram == t[3]
+            if (t[2] == "!=") return dram != t[3]
+            if (t[2] == ">=") return dram >= t[3]
+            if (t[2] == "<=") return dram <= t[3]
+            if (t[2] == ">")  return dram > t[3]
+            if (t[2] == "<")  return dram < t[3]
+            return 0
+        }
+        function taken(cond,   n, terms, i) {
+            gsub(/[()]/, " ", cond)
+            n = split(cond, terms, "&&")
+            for (i = 1; i <= n; i++)
+                if (!holds(terms[i])) return 0
+            return 1
+        }
+        {
+            line = $0
+            if (block && $1 ~ /^#if/) {
+                nested++
+            } else if (block && nested && $1 == "#endif") {
+                nested--
+            } else if (!block && $1 == "#if" && $0 ~ /DRAM/) {
+                block = 1; cond = $0; sub(/^[ \t]*#if/, "", cond)
+                active = taken(cond); done = active
+            } else if (block && !nested && $1 == "#elif") {
+                cond = $0; sub(/^[ \t]*#elif/, "", cond)
+                active = !done && taken(cond); done = done || active
+            } else if (block && !nested && $1 == "#else") {
+                active = !done
+            } else if (block && !nested && $1 == "#endif") {
+                block = 0
+            } else if ($1 == "#define" && $2 == name && (!block || active)) {
+                if (!set) { print $3; exit }
+                sub(/#define[ \t]+[^ \t]+[ \t]+[^ \t]+/, "#define " name "\t" value, line)
+            }
+            if (set) print line
+        }' "$file"
+}
+
+# HBM runs on HBM2, as in run_kernels_hbm.sh
+dram_config() {
+    case $1 in
+        HBM)    echo "$RAMULATOR_ROOT/configs/HBM2_AB-config.cfg" ;;
+        *)      echo "$RAMULATOR_ROOT/configs/$1_AB-config.cfg" ;;
+    esac
+}
+
+# Copy the sources needed to build and run one design point
+setup_point() {
+    local dir=$1
+
+    mkdir -p "$dir/build/src/tb" "$dir/inputs"
+    cp -r "$ANEMOS_DIR/src" "$dir/"
+    cp "$ANEMOS_DIR"/build/makefile "$ANEMOS_DIR"/build/sources.mk "$dir/build/"
+    cp "$ANEMOS_DIR"/build/src/subdir.mk "$dir/build/src/"
+    cp "$ANEMOS_DIR"/build/src/tb/subdir.mk "$dir/build/src/tb/"
+    cp -r "$ANEMOS_DIR/inputs/src" "$ANEMOS_DIR/inputs/compile_all.sh" "$dir/inputs/"
+    for d in SystemC address-input assembly-input bin data-input ramulator-in ramulator-out raw results; do
+        mkdir -p "$dir/inputs/$d"
+    done
+}
+
+# Build and run all the kernels of one design point, writing one row per kernel
+run_point() {
+    local dram=$1 cores=$2 grf=$3 dtype=$4
+    local point="${dram}_C${cores}_G${grf}_T${dtype}"
+    local dir="$OUT_DIR/points/$point"
+    local table="$dir/point.tsv"
+    local config
+    config=$(dram_config "$dram")
+
+    rm -rf "$dir"
+    setup_point "$dir"
+    : > "$table"
+
+    sed -i "s/#define GEM5 .*/#define GEM5        0/g" "$dir/src/defs.h"
+    sed -i "s/#define DRAM .*/#define DRAM    $(dram_index "$dram")/g" "$dir/src/defs.h"
+    local define defs="$dir/src/defs.h"
+    for define in "CORES_PER_PCH $cores" "GRF_ENTRIES $grf" "DATA_TYPE $dtype"; do
+        dram_define "$defs" "$(dram_index "$dram")" $define > "$defs.new" && mv "$defs.new" "$defs"
+    done
+
+    if ! make -C "$dir/build" all > "$dir/build.log" 2>&1 ||
+       ! (cd "$dir/inputs" && bash compile_all.sh) >> "$dir/build.log" 2>&1; then
+        while read -r name kernel args; do
+            [ -z "$name" ] && continue
+            printf "%s\t%s\t%s\t%s\t%s\t\t\tbuild_failed\n" "$dram" "$cores" "$grf" "$dtype" "$name" >> "$table"
+        done < "$KERNEL_LIST"
+        echo "$point: build failed, see $dir/build.log"
+        return
+    fi
+
+    while read -r name kernel args; do
+        [ -z "$name" ] && continue
+        local log="$dir/$name.log"
+        local start end cycles status
+
+        start=$(date +%s.%N)
+        (
+            cd "$dir/inputs" &&
+            bin/map_kernel "$name" "$kernel" $args &&
+            bin/nmc_assembler assembly-input/$name.asm raw/$name.seq data-input/$name.data address-input/$name.addr &&
+            bin/raw2ramulator raw/$name.seq ramulator-in/$name.trace &&
+            "$RAMULATOR_ROOT/ramulator" "$config" --mode=dram --stats "$dir/$name.stats" ramulator-in/$name.trace > ramulator-out/$name.cmd &&
+            bin/ramulator2sc raw/$name.seq ramulator-out/$name.cmd SystemC/$name.sci 1 &&
+            cd .. && build/nmc-cores "$name"
+        ) < /dev/null > "$log" 2>&1
+        status=$?
+        end=$(date +%s.%N)
+
+        cycles=$(grep "Simulation finished at cycle" "$log" | tail -1 | awk '{print $NF}')
+        if [ $status -eq 0 ] && [ -n "$cycles" ]; then
+            status="ok"
+        else
+            status="failed"
+        fi
+        printf "%s\t%s\t%s\t%s\t%s\t%s\t%.3f\t%s\n" "$dram" "$cores" "$grf" "$dtype" "$name" "$cycles" \
+            "$(awk "BEGIN {print $end - $start}")" "$status" >> "$table"
+
+        # Intermediate files of big kernels take a lot of space, only the results are kept
+        for d in assembly-input data-input address-input raw ramulator-in ramulator-out SystemC; do
+            rm -f "$dir/inputs/$d/$name".*
+        done
+        rm -f "$dir/pch_wave.vcd"
+    done < "$KERNEL_LIST"
+
+    echo "$point: done"
+}
+
+# Enumerate the grid, running at most JOBS points at the same time
+POINTS=()
+for dram in ${DRAMS//,/ }; do
+    if [ -z "$(dram_index "$dram")" ]; then
+        echo "Unknown DRAM standard $dram"
+        exit 1
+    fi
+    # Without a value on the command line, the one of defs.h for this DRAM
+    DEFS="$ANEMOS_DIR/src/defs.h"
+    index=$(dram_index "$dram")
+    cores_list=${CORES:-$(dram_define "$DEFS" "$index" CORES_PER_PCH)}
+    grf_list=${GRFS:-$(dram_define "$DEFS" "$index" GRF_ENTRIES)}
+    dtype_list=${DTYPES:-$(dram_define "$DEFS" "$index" DATA_TYPE)}
+    for cores in ${cores_list//,/ }; do
+        for grf in ${grf_list//,/ }; do
+            for dtype in ${dtype_list//,/ }; do
+                POINTS+=("${dram}_C${cores}_G${grf}_T${dtype}")
+                while [ "$(jobs -rp | wc -l)" -ge "$JOBS" ]; do
+                    wait -n
+                done
+                run_point "$dram" "$cores" "$grf" "$dtype" &
+            done
+        done
+    done
+done
+wait
+
+# Gather the results in grid order
+TABLE="$OUT_DIR/sweep.tsv"
+printf "dram\tcores_per_pch\tgrf_entries\tdata_type\tkernel\tnmc_cycles\thost_seconds\tstatus\n" > "$TABLE"
+for point in "${POINTS[@]}"; do
+    cat "$OUT_DIR/points/$point/point.tsv" >> "$TABLE"
+done
+
+echo "Results of ${#POINTS[@]} design points written to $TABLE"
@@ -0,0 +1,117 @@
+/*
+ * Copyright EPFL 2024
+ * Rafael Medina Morillas
+ *
+ * Description of a transactional bank-data channel, used instead of the resolved
+ * sc_signal_rv bank buses when BANK_CHANNEL is enabled.
+ *
+ * The bus carries the column of a bank as DWORDS_PER_COL 64-bit words. The
+ * driver and the core each have their own side of the bus, which they drive or
+ * release. As for a signal, writes become visible in the next delta cycle.
+ *
+ */
+
+#ifndef BANK_CHANNEL_H_
+#define BANK_CHANNEL_H_
+
+#ifndef __SYNTHESIS__
+
+#include <cstring>
+#include "systemc.h"
+#include "datatypes.h"
+
+// Contents of a bank bus
+typedef struct bank_data {
+    uint64_t word[DWORDS_PER_COL];
+} bank_data;
+
+// Element of WORD_BITS bits at the given position of the bus
+inline uint64_t bank_element(const bank_data& data, int index) {
+    uint64_t word = data.word[(WORD_BITS * index) / 64] >> ((WORD_BITS * index) % 64);
+    return (WORD_BITS == 64) ? word : word & ((1ULL << (WORD_BITS % 64)) - 1);
+}
+
+inline void set_bank_element(bank_data& data, int index, uint64_t value) {
+    uint64_t mask = (WORD_BITS == 64) ? ~0ULL : ((1ULL << (WORD_BITS % 64)) - 1);
+    int shift = (WORD_BITS * index) % 64;
+    uint64_t& word = data.word[(WORD_BITS * index) / 64];
+    word = (word & ~(mask << shift)) | ((value & mask) << shift);
+}
+
+class bank_bus_if: virtual public sc_interface {
+public:
+    virtual void drive_host(const bank_data& data) = 0;    // Driver puts data on the bus (PIM RD from the bank)
+    virtual void release_host() = 0;                        // Driver stops driving the bus
+    virtual void drive_bank(const bank_data& data) = 0;    // Core puts data on the bus (PIM WR to the bank)
+    virtual void release_bank() = 0;                        // Core stops driving the bus
+    virtual const bank_data& read() const = 0;              // Value on the bus, zero if nobody drives it
+};
+
+class bank_channel: public sc_prim_channel, public bank_bus_if {
+public:
+    bank_channel() : sc_prim_channel(sc_gen_unique_name("bank_channel")) { init(); }
+    explicit bank_channel(const char* name_) : sc_prim_channel(name_) { init(); }
+
+    void drive_host(const bank_data& data) {
+        if (host_on && !memcmp(&host, &data, sizeof(data)))
+            return;
+        host = data;
+        host_on = true;
+        request_update();
+    }
+
+    void release_host() {
+        if (!host_on)
+            return;
+        host_on = false;
+        request_update();
+    }
+
+    void drive_bank(const bank_data& data) {
+        if (bank_on && !memcmp(&bank, &data, sizeof(data)))
+            return;
+        bank = data;
+        bank_on = true;
+        request_update();
+    }
+
+    void release_bank() {
+        if (!bank_on)
+            return;
+        bank_on = false;
+        request_update();
+    }
+
+    const bank_data& read() const { return value; }
+
+    const sc_event& default_event() const { return changed; }
+
+protected:
+    // Resolves the bus. The driver and the core never drive it at the same time,
+    // if they did the core would win instead of producing X as the resolved buses.
+    void update() {
+        const bank_data& next = bank_on ? bank : (host_on ? host : zero);
+        if (memcmp(&value, &next, sizeof(next))) {
+            value = next;
+            changed.notify(SC_ZERO_TIME);
+        }
+    }
+
+private:
+    bank_data host, bank, value, zero;
+    bool host_on, bank_on;
+    sc_event changed;
+
+    void init() {
+        memset(&host, 0, sizeof(host));
+        memset(&bank, 0, sizeof(bank));
+        memset(&value, 0, sizeof(value));
+        memset(&zero, 0, sizeof(zero));
+        host_on = false;
+        bank_on = false;
+    }
+};
+
+#endif
+
+#endif /* BANK_CHANNEL_H_ */
@@ -0,0 +1,42 @@
+ /*
+ * Copyright EPFL 2024
+ * Rafael Medina Morillas
+ *
+ * Activity counters of the NMC cores, used by gem5 for the energy accounting.
+ *
+ * The instruction decoders add up, at every clock edge, the operations their
+ * datapath performs. In gem5 simulations the driver publishes the totals in the
+ * shared memory, after the FileLines and the last command flag, so NMCcores can
+ * turn them into stats. This file is shared with gem5-x-nmc/ext/NMCcores.
+ *
+ */
+
+#ifndef CNM_ACTIVITY_H_
+#define CNM_ACTIVITY_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef struct cnm_activity {
+    uint64_t instructions;  // CRF instructions decoded in PIM mode
+    uint64_t mult_ops;      // FPU multiplications, one per SIMD lane
+    uint64_t add_ops;       // FPU additions, one per SIMD lane
+    uint64_t grf_reads;     // GRF reads, one per SIMD-wide register
+    uint64_t grf_writes;    // GRF writes, one per SIMD-wide register
+    uint64_t srf_reads;     // SRF reads
+    uint64_t srf_writes;    // SRF writes
+    uint64_t crf_writes;    // CRF writes from the host
+} cnm_activity;
+
+// Offset of the counters in the shared memory with gem5, aligned after the FileLines and the last command flag
+#define CNM_ACTIVITY_OFFSET(fileLinesBytes)  ((((fileLinesBytes) + sizeof(uint8_t)) + 7) & ~((size_t) 7))
+
+#ifndef __SYNTHESIS__
+// Totals of all the cores, the SystemC kernel runs them on a single thread
+inline cnm_activity& cnm_activity_total() {
+    static cnm_activity total = {};
+    return total;
+}
+#endif
+
+#endif /* CNM_ACTIVITY_H_ */
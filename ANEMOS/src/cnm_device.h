@@ -27,8 +27,13 @@ class cnm_device: public sc_module {
     sc_in<sc_uint<ROW_BITS> >       row_addr[NUM_CHANNEL];                     // Address of the bank row
     sc_in<sc_uint<COL_BITS> >       col_addr[NUM_CHANNEL];                     // Address of the bank column
     sc_in<sc_uint<DQ_BITS> >        DQ[NUM_CHANNEL];                           // Data input from DRAM controller (output makes no sense)
+#if BANK_CHANNEL
+    sc_port<bank_bus_if>            even_buses[NUM_CHANNEL][CORES_PER_PCH];    // Direct data in/out to the even banks
+    sc_port<bank_bus_if>            odd_buses[NUM_CHANNEL][CORES_PER_PCH];     // Direct data in/out to the odd banks
+#else
     sc_inout_rv<GRF_WIDTH>          even_buses[NUM_CHANNEL][CORES_PER_PCH];    // Direct data in/out to the even banks
     sc_inout_rv<GRF_WIDTH>          odd_buses[NUM_CHANNEL][CORES_PER_PCH];     // Direct data in/out to the odd banks
+#endif
 
     // ** INTERNAL SIGNALS AND VARIABLES **
 
@@ -12,8 +12,11 @@
 
 #define MIXED_SIM   0   // 0 if SystemC-only simulation, 1 if mixed SystemC + RTL
 #define GEM5        1
-#define OUTPUT_LOG  1
+#define OUTPUT_LOG  2   // Results file: 0 off, 1 summary (cycle and address of bank writes), 2 full (also the data)
 #define DEBUG       0
+#define FAST_RF     1   // 1 for the simulation-only RF model (plain arrays), 0 for the signal-based one
+#define BANK_CHANNEL GEM5   // 1 for transactional bank buses (cnm testbench only), 0 for resolved sc_signal_rv buses
+#define NMC_ACTIVITY GEM5   // 1 to count the operations of the cores, reported to gem5 for the energy stats
 
 #define RESOLUTION SC_PS
 
@@ -32,6 +35,9 @@
 // 1: DDR4_AB
 // 2: GDDR5_AB
 // 3: LPDDR4_AB
+// 4: PCM_AB
+// 5: RRAM_AB
+// 6: STTRAM_AB
 
 #define DRAM    0
 
@@ -71,6 +77,16 @@
     #define ROW_BITS        15
     #define COL_BITS        6 //6+4
     #define GLOBAL_OFFSET   6
+#elif (DRAM >= 4 && DRAM <= 6)
+    // The NVM standards share the DDR4-like organization (4Gb_x8) at 400 MHz
+    #define CLK_PERIOD 2500
+    #define CHANNEL_BITS    0
+    #define RANK_BITS       0
+    #define BG_BITS         2
+    #define BANK_BITS       2
+    #define ROW_BITS        15
+    #define COL_BITS        7
+    #define GLOBAL_OFFSET   6
 #endif
 
 // Sizing constants
@@ -87,6 +103,9 @@
 #elif (DRAM == 3)
     #define CORES_PER_PCH   4
 	#define GRF_WIDTH		256
+#elif (DRAM >= 4 && DRAM <= 6)
+    #define CORES_PER_PCH   8
+	#define GRF_WIDTH		64
 #endif
 #define CRF_ENTRIES     32
 #define SRF_A_ENTRIES   8
@@ -158,12 +158,19 @@ void imc_core::comb_method() {
     sc_uint<INSTR_BITS> ext2crf_tmp;
     sc_uint<WORD_BITS> ext2srf_tmp, ext2grf_tmp[SIMD_WIDTH];
 
+#if BANK_CHANNEL
+    const bank_data& even_tmp = even_bus->read();
+    const bank_data& odd_tmp = odd_bus->read();
+    uint64_t even2grfa_tmp[SIMD_WIDTH], odd2grfb_tmp[SIMD_WIDTH];
+    bank_data grfa2even_tmp = {}, grfb2odd_tmp = {};
+#else
     sc_lv<GRF_WIDTH> even_tmp = even_bus;
     sc_lv<GRF_WIDTH> odd_tmp = odd_bus;
     sc_lv<WORD_BITS> even2grfa_tmp[SIMD_WIDTH], odd2grfb_tmp[SIMD_WIDTH];
+    sc_lv<GRF_WIDTH> grfa2even_tmp, grfb2odd_tmp;
+#endif
     cnm_t cnm_aux;
     sc_int<WORD_BITS> grfa_tmp[SIMD_WIDTH], grfb_tmp[SIMD_WIDTH];  
-    sc_lv<GRF_WIDTH> grfa2even_tmp, grfb2odd_tmp;
 
 #if (!(HALF_FLOAT) && !(INT_TYPE))
     // Union variables for conversion between FP and binary
@@ -207,6 +214,24 @@ void imc_core::comb_method() {
 
     // Adapt bank buses to GRFs
     for (int i = 0; i < SIMD_WIDTH; i++) {
+#if BANK_CHANNEL
+        even2grfa_tmp[i] = bank_element(even_tmp, i);
+        odd2grfb_tmp[i] = bank_element(odd_tmp, i);
+#if HALF_FLOAT
+        even2grfa[i] = half_float::half(half_float::detail::binary, even2grfa_tmp[i]);
+        odd2grfb[i] = half_float::half(half_float::detail::binary, odd2grfb_tmp[i]);
+#else
+        #if INT_TYPE
+                even2grfa[i] = even2grfa_tmp[i];
+                odd2grfb[i] = odd2grfb_tmp[i];
+        #else
+                union_even2grfa[i].bin = even2grfa_tmp[i];
+                even2grfa[i] = union_even2grfa[i].data;
+                union_odd2grfb[i].bin = odd2grfb_tmp[i];
+                odd2grfb[i] = union_odd2grfb[i].data;
+        #endif
+#endif
+#else
         even2grfa_tmp[i] = even_tmp.range(WORD_BITS * (i + 1) - 1, WORD_BITS * i);
         odd2grfb_tmp[i] = odd_tmp.range(WORD_BITS * (i + 1) - 1, WORD_BITS * i);
 #if HALF_FLOAT
@@ -224,6 +249,7 @@ void imc_core::comb_method() {
                 union_odd2grfb[i].bin = odd2grfb_tmp[i].to_uint64();
                 odd2grfb[i] = union_odd2grfb[i].data;
         #endif
+#endif
 #endif
     }
 
@@ -240,8 +266,12 @@ void imc_core::comb_method() {
                 grfa_tmp[i] = union_aux.bin;
         #endif
 #endif
+#if BANK_CHANNEL
+        set_bank_element(grfa2even_tmp, i, grfa_tmp[i].to_uint64());
+#else
         grfa2even_tmp.range(WORD_BITS * (i + 1) - 1, WORD_BITS * i) =
                 grfa_tmp[i];
+#endif
 #if HALF_FLOAT
         cnm_aux = grfb_out1[i];
         grfb_tmp[i] = cnm_aux.bin_word();
@@ -253,11 +283,29 @@ void imc_core::comb_method() {
                 grfb_tmp[i] = union_aux.bin;
         #endif
 #endif
+#if BANK_CHANNEL
+        set_bank_element(grfb2odd_tmp, i, grfb_tmp[i].to_uint64());
+#else
         grfb2odd_tmp.range(WORD_BITS * (i + 1) - 1, WORD_BITS * i) =
                 grfb_tmp[i];
+#endif
+    }
+#if BANK_CHANNEL
+    // Drive the bank channels only when the control unit enables the outputs
+    if (even_out_en) {
+        even_bus->drive_bank(grfa2even_tmp);
+    } else {
+        even_bus->release_bank();
+    }
+    if (odd_out_en) {
+        odd_bus->drive_bank(grfb2odd_tmp);
+    } else {
+        odd_bus->release_bank();
     }
+#else
     grfa2even = grfa2even_tmp;
     grfb2odd = grfb2odd_tmp;
+#endif
 
 #endif
 
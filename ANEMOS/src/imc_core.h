@@ -17,6 +17,7 @@
 #include "grf.h"
 #include "srf.h"
 #include "tristate_buffer.h"
+#include "bank_channel.h"
 
 class imc_core: public sc_module {
 public:
@@ -286,8 +287,13 @@ public:
     sc_in<sc_uint<ROW_BITS> >   row_addr;	// Address of the bank row
     sc_in<sc_uint<COL_BITS> >   col_addr;	// Address of the bank column
     sc_in<sc_uint<DQ_BITS> >    DQ;	        // Data input from DRAM controller (output makes no sense)
+#if BANK_CHANNEL
+    sc_port<bank_bus_if>        even_bus;	// Direct data in/out to the even bank
+    sc_port<bank_bus_if>        odd_bus;	// Direct data in/out to the odd bank
+#else
     sc_inout_rv<GRF_WIDTH>      even_bus;	// Direct data in/out to the even bank
     sc_inout_rv<GRF_WIDTH>      odd_bus;	// Direct data in/out to the odd bank
+#endif
 
     // ** INTERNAL SIGNALS AND VARIABLES **
     // Basic control
@@ -323,7 +329,9 @@ public:
     sc_signal<uint32_t>             ext2crf;
     sc_signal<cnm_t>                ext2srf, ext2grf[SIMD_WIDTH];
     sc_signal<cnm_t>                even2grfa[SIMD_WIDTH], odd2grfb[SIMD_WIDTH];
+#if !(BANK_CHANNEL)
     sc_signal<sc_lv<GRF_WIDTH> >    grfa2even, grfb2odd;
+#endif
 
     // Internal modules
     control_unit *cu;
@@ -331,7 +339,9 @@ public:
     crf *controlrf;
     grf *grfa, *grfb;
     srf *scalarrf;
+#if !(BANK_CHANNEL)
     tristate_buffer<GRF_WIDTH> *even_buf, *odd_buf;
+#endif
 
     SC_HAS_PROCESS(imc_core);
     imc_core(sc_module_name name) : sc_module(name) {
@@ -475,6 +485,11 @@ public:
         scalarrf->grfa_in(grfa_out1[0]);
         scalarrf->grfb_in(grfb_out1[0]);
 
+#if BANK_CHANNEL
+        // The core drives its side of the bank channels in comb_method
+        SC_METHOD(comb_method);
+        sensitive << data_out << even_bus << odd_bus << even_out_en << odd_out_en;
+#else
         even_buf = new tristate_buffer<GRF_WIDTH>("Even_tristate_buffer");
         even_buf->input(grfa2even);
         even_buf->enable(even_out_en);
@@ -487,6 +502,7 @@ public:
 
         SC_METHOD(comb_method);
         sensitive << data_out << even_bus << odd_bus;
+#endif
         for (i = 0; i < SIMD_WIDTH; i++) {
             sensitive << grfa_out1[i] << grfb_out1[i];
         }
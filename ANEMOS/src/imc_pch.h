@@ -82,8 +82,13 @@ public:
     sc_in<sc_uint<ROW_BITS> >   row_addr;				    // Address of the bank row
     sc_in<sc_uint<COL_BITS> >   col_addr;			        // Address of the bank column
     sc_in<sc_uint<DQ_BITS> >    DQ;	                        // Data input from DRAM controller (output makes no sense)
+#if BANK_CHANNEL
+    sc_port<bank_bus_if>        even_buses[CORES_PER_PCH];  // Direct data in/out to the even banks
+    sc_port<bank_bus_if>        odd_buses[CORES_PER_PCH];   // Direct data in/out to the odd banks
+#else
     sc_inout_rv<GRF_WIDTH>      even_buses[CORES_PER_PCH];  // Direct data in/out to the even banks
     sc_inout_rv<GRF_WIDTH>      odd_buses[CORES_PER_PCH];   // Direct data in/out to the odd banks
+#endif
 
     // ** INTERNAL SIGNALS AND VARIABLES **
 
@@ -69,6 +69,9 @@ void instr_decoder::clk_thread() {
 
     // Update registers and advance pipelines
     while (1) {
+#if NMC_ACTIVITY && !defined(__SYNTHESIS__)
+        count_activity();
+#endif
 
         // NOP
         nop_cnt_reg = nop_cnt_nxt;
@@ -278,6 +281,55 @@ void instr_decoder::clk_thread() {
     }
 }
 
+#if NMC_ACTIVITY && !defined(__SYNTHESIS__)
+void instr_decoder::count_activity() {
+    cnm_activity& act = cnm_activity_total();
+
+    if (decode_en->read() && !rf_access->read()) {
+        act.instructions++;
+    }
+    if (crf_wr_en->read()) {
+        act.crf_writes++;
+    }
+
+    // FPU operations and the register operands they read
+    if (fpu_mult_en->read()) {
+        act.mult_ops += SIMD_WIDTH;
+        uint8_t in1 = fpu_mult_in1_sel->read(), in2 = fpu_mult_in2_sel->read();
+        act.grf_reads += (in1 <= M1_GRF_B2) + (in2 >= M2_GRF_A1 && in2 <= M2_GRF_B2);
+        act.srf_reads += (in2 == M2_SRF);
+    }
+    if (fpu_add_en->read()) {
+        act.add_ops += SIMD_WIDTH;
+        uint8_t in1 = fpu_add_in1_sel->read(), in2 = fpu_add_in2_sel->read();
+        act.grf_reads += (in1 >= A_GRF_A1 && in1 <= A_GRF_B2) + (in2 >= A_GRF_A1 && in2 <= A_GRF_B2);
+        act.srf_reads += (in1 == A_SRF) + (in2 == A_SRF);
+    }
+
+    // Register writes, and the register reads of the MOVs feeding them
+    if (grfa_wr_en->read()) {
+        act.grf_writes++;
+        uint8_t from = grfa_wr_from->read();
+        act.grf_reads += (from == MUX_GRF_A || from == MUX_GRF_B);
+        act.srf_reads += (from == MUX_SRF);
+    }
+    if (grfb_wr_en->read()) {
+        act.grf_writes++;
+        uint8_t from = grfb_wr_from->read();
+        act.grf_reads += (from == MUX_GRF_A || from == MUX_GRF_B);
+        act.srf_reads += (from == MUX_SRF);
+    }
+    if (srf_wr_en->read()) {
+        act.srf_writes++;
+        uint8_t from = srf_wr_from->read();
+        act.grf_reads += (from == MUX_GRF_A || from == MUX_GRF_B);
+    }
+
+    // MOVs from the GRFs to the banks
+    act.grf_reads += even_out_en->read() + odd_out_en->read();
+}
+#endif
+
 void instr_decoder::comb_method() {
 
     // Break the instruction word into the different fields
@@ -12,6 +12,7 @@
 #include "systemc.h"
 
 #include "cnm_base.h"
+#include "cnm_activity.h"
 
 class instr_decoder: public sc_module {
 public:
@@ -280,6 +281,9 @@ public:
     void clk_thread();	// Performs sequential logic (and resets)
     void comb_method(); // Performs the combinational logic
     void out_method();	// Performs output combinational logic
+#if NMC_ACTIVITY && !defined(__SYNTHESIS__)
+    void count_activity();	// Adds the operations enabled at this clock edge to cnm_activity_total()
+#endif
 };
 
 #endif /* INSTR_DECODER_H_ */
@@ -10,6 +10,9 @@
 #define RF_THREEPORT_H_
 
 #include "systemc.h"
+#include "defs.h"
+
+#if !(FAST_RF) || defined(__SYNTHESIS__)
 
 template<class T, uint size>
 class rf_threeport: public sc_module {
@@ -74,4 +77,61 @@ public:
     }
 };
 
+#else
+
+// Simulation-only model: the contents are a plain array instead of one signal
+// per entry, and the read ports are only evaluated when the read address
+// changes or an entry is written, instead of on any change of any entry.
+template<class T, uint size>
+class rf_threeport: public sc_module {
+public:
+    sc_in_clk clk;
+    sc_in<bool> rst;
+    sc_in<uint> rd_addr1;	// Index read
+    sc_in<uint> rd_addr2;	// Index read
+    sc_out<T>   rd_port1;	// Read port
+    sc_out<T>   rd_port2;	// Read port
+    sc_in<bool> wr_en;		// Enable writing
+    sc_in<uint> wr_addr;	// Index the address to be written
+    sc_in<T>    wr_port;	// Write port
+
+    //Internal signals and variables
+    T reg[size];        // Register file contents
+    sc_event written;   // Notified after every write, to update the read ports
+
+    SC_CTOR(rf_threeport) {
+        SC_METHOD(read_method);
+        sensitive << rd_addr1 << rd_addr2 << written;
+
+        SC_METHOD(write_method);
+        sensitive << clk.pos() << rst;
+        dont_initialize();
+
+        for (uint i = 0; i < size; i++)
+            reg[i] = (T) 0;
+
+    }
+
+    // Shows the indexed contents for reading
+    void read_method() {
+        rd_port1->write(rd_addr1->read() < size ? reg[rd_addr1->read()] : (T) 0);
+        rd_port2->write(rd_addr2->read() < size ? reg[rd_addr2->read()] : (T) 0);
+    }
+
+    // Write to the RF, with asynchronous reset
+    void write_method() {
+        if (!rst->read()) {
+            for (uint i = 0; i < size; i++) {
+                reg[i] = (T) 0;
+            }
+            written.notify(SC_ZERO_TIME);
+        } else if (clk.posedge() && wr_en->read() && wr_addr->read() < size) {
+            reg[wr_addr->read()] = wr_port->read();
+            written.notify(SC_ZERO_TIME);
+        }
+    }
+};
+
+#endif
+
 #endif /* RF_THREEPORT_H_ */
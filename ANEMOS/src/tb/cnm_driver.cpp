@@ -3,6 +3,7 @@
 #if MIXED_SIM == 0  // Testbench for SystemC simulation
 #if GEM5 == 0
 #include "cnm_driver.h"
+#include "cnm_logger.h"
 
 #include <cstdio>
 #include <cstdlib>
@@ -24,9 +25,13 @@ void cnm_driver::driver_thread() {
 #if INSTR_CLK > 1
     int instrCycle[NUM_CHANNEL];
 #endif
+#if BANK_CHANNEL
+    bank_data bankAux;
+#else
     sc_biguint<GRF_WIDTH> bankAux;
-    sc_uint<DQ_BITS> bank2out;
     sc_lv<GRF_WIDTH> allzs(SC_LOGIC_Z);
+#endif
+    sc_uint<DQ_BITS> bank2out;
     bool lastCmd[NUM_CHANNEL], bankRead[NUM_CHANNEL], bankWrite[NUM_CHANNEL];
 
     sc_uint<ADDR_TOTAL_BITS> addrAux[NUM_CHANNEL];
@@ -36,14 +41,22 @@ void cnm_driver::driver_thread() {
     uint64_t readCycle[NUM_CHANNEL] = {0};
     unsigned long int readAddr[NUM_CHANNEL];
     dq_type dataAux, data2DQ, data2bankAux;
+#if BANK_CHANNEL
+    bank_data data2bank;
+#else
     sc_biguint<GRF_WIDTH> data2bank;
+#endif
     string readCmd[NUM_CHANNEL];
     dq_type data2DQAux[NUM_CHANNEL][DQ_CLK];
 #if INSTR_CLK > 1
     dq_type instr2DQAux[NUM_CHANNEL][INSTR_CLK];
 #endif
     deque<dq_type> readData[NUM_CHANNEL];
+#if BANK_CHANNEL
+    deque<bank_data> data2bankBuffer[NUM_CHANNEL];
+#else
     deque<sc_biguint<GRF_WIDTH> > data2bankBuffer[NUM_CHANNEL];
+#endif
 
     assert(NUM_CHANNEL <= (1 << CHANNEL_BITS));    // Check if the number of channels is within the address space
 
@@ -68,8 +81,13 @@ void cnm_driver::driver_thread() {
         col_addr[i]->write(0);
         DQ[i]->write(0);
         for (j = 0; j < CORES_PER_PCH; j++) {
+#if BANK_CHANNEL
+            even_buses[i][j]->release_host();
+            odd_buses[i][j]->release_host();
+#else
             even_buses[i][j]->write(allzs);
             odd_buses[i][j]->write(allzs);
+#endif
         }
     }
 
@@ -81,34 +99,33 @@ void cnm_driver::driver_thread() {
     curCycle++;
 
     // Open input file
-    string fi[NUM_CHANNEL], fo[NUM_CHANNEL];
+    string fi[NUM_CHANNEL];
+    string fo = "inputs/results/" + filename + ".results";   // Output file name, located in pim-cores folder
     ifstream input[NUM_CHANNEL];
-    ofstream output[NUM_CHANNEL];
+    cnm_logger output;
     bool valid_input[NUM_CHANNEL] = {true};
     bool some_valid = false;
 
     for (i = 0; i < NUM_CHANNEL; i++) {
         fi[i] = "inputs/SystemC/" + filename + ".sci" + to_string(i);     // Input file name, located in pim-cores folder
-        fo[i] = "inputs/results/" + filename + ".results" + to_string(i);  // Output file name, located in pim-cores folder
         input[i].open(fi[i]);
-        output[i].open(fo[i]);
         if (!input[i].is_open())   {
             cout << "Error when opening input file " << fi[i] << endl;
             valid_input[i] = false;
         }
-        if (!output[i].is_open())   {
-            cout << "Error when opening output file " << fo[i] << endl;
-            sc_stop();
-            return;
-        }
+    }
+    if (!output.open(fo, NUM_CHANNEL, OUTPUT_LOG, DATA_TYPE, DQ_CLK*CORES_PER_PCH)) {
+        cout << "Error when opening output file " << fo << endl;
+        sc_stop();
+        return;
     }
     
     for (i = 0; i < NUM_CHANNEL; i++)  some_valid |= valid_input[i];
     if (!some_valid) {
         for (i = 0; i < NUM_CHANNEL; i++) {
             input[i].close();
-            output[i].close();
         }
+        output.close();
         cout << "Not able to open any input file" << endl;
         sc_stop();
         return;
@@ -150,8 +167,13 @@ void cnm_driver::driver_thread() {
                 pim_mode[i]->write(true);
                 DQ[i]->write(0);
                 for (j = 0; j < CORES_PER_PCH; j++) {
+#if BANK_CHANNEL
+                    even_buses[i][j]->release_host();
+                    odd_buses[i][j]->release_host();
+#else
                     even_buses[i][j]->write(allzs);
                     odd_buses[i][j]->write(allzs);
+#endif
                 }
 
                 // Keep writing to DQ to finish GRF writing
@@ -171,12 +193,20 @@ void cnm_driver::driver_thread() {
                 if (bankRead[i]) {
                     if (addrAux[i].range(BA_END, BA_END)) {
                         for (j = 0; j < CORES_PER_PCH; j++) {
+#if BANK_CHANNEL
+                            odd_buses[i][j]->drive_host(data2bankBuffer[i].front());
+#else
                             odd_buses[i][j]->write(data2bankBuffer[i].front());
+#endif
                             data2bankBuffer[i].pop_front();
                         }
                     } else {
                         for (j = 0; j < CORES_PER_PCH; j++) {
+#if BANK_CHANNEL
+                            even_buses[i][j]->drive_host(data2bankBuffer[i].front());
+#else
                             even_buses[i][j]->write(data2bankBuffer[i].front());
+#endif
                             data2bankBuffer[i].pop_front();
                         }
                     }
@@ -272,7 +302,11 @@ void cnm_driver::driver_thread() {
                                     for (k = 0; k < DQ_CLK; k++){
                                         data2bankAux = readData[i].front();
                                         readData[i].pop_front();
+#if BANK_CHANNEL
+                                        data2bank.word[k] = data2bankAux;
+#else
                                         data2bank.range(DQ_BITS*(k+1)-1,DQ_BITS*k) = data2bankAux;
+#endif
                                     }
                                     data2bankBuffer[i].push_back(data2bank);
                                 }
@@ -290,8 +324,7 @@ void cnm_driver::driver_thread() {
                             bankWrite[i] = true;
 
                             // Write address here because it will be overwritten later with the next cmd
-
-                            output[i] << showbase << dec << curCycle << "\t" << hex << readAddr[i] << "\t";
+                            output.record(i, curCycle, readAddr[i]);
 
                         }
                     }
@@ -318,7 +351,6 @@ void cnm_driver::driver_thread() {
 
                 } else if (lastCmd[i] && curCycle >= readCycle[i]) {
                     // End of simulation, last command was already read
-                    output[i].close();
                     valid_input[i] = false;
                 }
 
@@ -340,20 +372,27 @@ void cnm_driver::driver_thread() {
                         for (j = 0; j < CORES_PER_PCH; j++) {
                             bankAux = odd_buses[i][j]->read();
                             for (k = 0; k < DQ_CLK; k++) {
+#if BANK_CHANNEL
+                                bank2out = bankAux.word[k];
+#else
                                 bank2out = bankAux.range(DQ_BITS*(k+1)-1,DQ_BITS*k);
-                                output[i] << showbase << hex << bank2out << "\t";
+#endif
+                                output.data(i, bank2out);
                             }
                         }
                     } else {
                         for (j = 0; j < CORES_PER_PCH; j++) {
                             bankAux = even_buses[i][j]->read();
                             for (k = 0; k < DQ_CLK; k++) {
+#if BANK_CHANNEL
+                                bank2out = bankAux.word[k];
+#else
                                 bank2out = bankAux.range(DQ_BITS*(k+1)-1,DQ_BITS*k);
-                                output[i] << showbase << hex << bank2out << "\t";
+#endif
+                                output.data(i, bank2out);
                             }
                         }
                     }
-                    output[i] << endl;
 
                     bankWrite[i] = false;
                 }
@@ -371,6 +410,7 @@ void cnm_driver::driver_thread() {
         curCycle++;
     }
 
+    output.close();
     cout << "Simulation finished at cycle " << dec << curCycle << endl;
 
     // Stop simulation
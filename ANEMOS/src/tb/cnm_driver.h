@@ -1,5 +1,7 @@
 #include "systemc.h"
 #include "../cnm_base.h"
+#include "../bank_channel.h"
+#include "../cnm_activity.h"
 
 #if GEM5
     //Needed libraries for semaphores/shared memory (testbench stuff)
@@ -17,9 +19,11 @@
     #include <stdint.h>
     #include <fstream>
     #include <string>
+    #include <chrono>
     #define RF_START    (1UL << (GLOBAL_OFFSET + CHANNEL_BITS + COL_BITS + RANK_BITS + BG_BITS + BANK_BITS + ROW_BITS - 1))
     #define TICK_THRESHOLD  (1 << 20)
     #define TICK_BACKUP     20000 // changed 10k to 20k, possible reason for the bug
+    #define BUS_SETTLE      1     // Time the driver lets the bank channels settle before reading them, in RESOLUTION units
 #endif
 
 class cnm_driver: public sc_module {
@@ -36,8 +40,13 @@ public:
     sc_out<sc_uint<ROW_BITS> >  row_addr[NUM_CHANNEL];                   // Address of the bank row
     sc_out<sc_uint<COL_BITS> >  col_addr[NUM_CHANNEL];                   // Address of the bank column
     sc_out<sc_uint<DQ_BITS> >   DQ[NUM_CHANNEL];                         // Data input from DRAM controller (output makes no sense)
+#if BANK_CHANNEL
+    sc_port<bank_bus_if>        even_buses[NUM_CHANNEL][CORES_PER_PCH];  // Direct data in/out to the even banks
+    sc_port<bank_bus_if>        odd_buses[NUM_CHANNEL][CORES_PER_PCH];   // Direct data in/out to the odd banks
+#else
     sc_inout_rv<GRF_WIDTH>      even_buses[NUM_CHANNEL][CORES_PER_PCH];  // Direct data in/out to the even banks
     sc_inout_rv<GRF_WIDTH>      odd_buses[NUM_CHANNEL][CORES_PER_PCH];   // Direct data in/out to the odd banks
+#endif
 
 #if GEM5
     //Communicating struct with gem5
@@ -55,6 +64,11 @@ public:
                         FileLine* srcFileLine, uint8_t* srcLastCmd);
     void printFileLine(FileLine* fl);
     void printSharedMem(FileLine* fl, uint8_t* lastCmdPtr);
+    void waitGem5(sem_t* sem);   // Blocks on the semaphore, accounting the host time spent waiting for gem5
+    void postGem5(sem_t* sem);   // Publishes the activity counters and hands the shared memory back to gem5
+
+    double gem5WaitSeconds = 0;
+    cnm_activity* sharedActivity = NULL;    // Activity counters in the shared memory, read by NMCcores
 
     //Shared memory and semaphores
     std::string semName1 = "/semaphoreOne";
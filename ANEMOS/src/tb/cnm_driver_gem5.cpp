@@ -3,6 +3,7 @@
 #if MIXED_SIM == 0  // Testbench for SystemC simulation
 #if GEM5 == 1
 #include "cnm_driver.h"
+#include "cnm_logger.h"
 
 #include <cstdio>
 #include <cstdlib>
@@ -59,6 +60,19 @@ void cnm_driver::printSharedMem (FileLine* fl, uint8_t* lastCmdPtr) {
     cout << "---------------" << endl;
 }
 
+void cnm_driver::waitGem5 (sem_t* sem) {
+    auto start = chrono::steady_clock::now();
+    sem_wait(sem);
+    gem5WaitSeconds += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+void cnm_driver::postGem5 (sem_t* sem) {
+#if NMC_ACTIVITY
+    *sharedActivity = cnm_activity_total();
+#endif
+    sem_post(sem);
+}
+
 void cnm_driver::driver_thread() {
 
     int i, j, k, DQCycle[NUM_CHANNEL];
@@ -66,9 +80,13 @@ void cnm_driver::driver_thread() {
 #if INSTR_CLK > 1
     int instrCycle[NUM_CHANNEL];
 #endif
+#if BANK_CHANNEL
+    bank_data bankAux;
+#else
     sc_biguint<GRF_WIDTH> bankAux;
-    sc_uint<DQ_BITS> bank2out;
     sc_lv<GRF_WIDTH> allzs(SC_LOGIC_Z);
+#endif
+    sc_uint<DQ_BITS> bank2out;
     bool bankRead[NUM_CHANNEL], bankWrite[NUM_CHANNEL];
 
     sc_uint<ADDR_TOTAL_BITS> addrAux[NUM_CHANNEL];
@@ -79,14 +97,22 @@ void cnm_driver::driver_thread() {
     uint64_t readCycle[NUM_CHANNEL] = {0};
     unsigned long int readAddr[NUM_CHANNEL];
     dq_type data2DQ, data2bankAux;
+#if BANK_CHANNEL
+    bank_data data2bank;
+#else
     sc_biguint<GRF_WIDTH> data2bank;
+#endif
     string readCmd[NUM_CHANNEL];
     dq_type data2DQAux[NUM_CHANNEL][DQ_CLK];
 #if INSTR_CLK > 1
     dq_type instr2DQAux[NUM_CHANNEL][INSTR_CLK];
 #endif
     deque<dq_type> readData[NUM_CHANNEL];
+#if BANK_CHANNEL
+    deque<bank_data> data2bankBuffer[NUM_CHANNEL];
+#else
     deque<sc_biguint<GRF_WIDTH> > data2bankBuffer[NUM_CHANNEL];
+#endif
 
     assert(NUM_CHANNEL <= (1 << CHANNEL_BITS));    // Check if the number of channels is within the address space
 
@@ -110,8 +136,13 @@ void cnm_driver::driver_thread() {
         col_addr[i]->write(0);
         DQ[i]->write(0);
         for (j = 0; j < CORES_PER_PCH; j++) {
+#if BANK_CHANNEL
+            even_buses[i][j]->release_host();
+            odd_buses[i][j]->release_host();
+#else
             even_buses[i][j]->write(allzs);
             odd_buses[i][j]->write(allzs);
+#endif
         }
     }
 
@@ -134,13 +165,15 @@ void cnm_driver::driver_thread() {
         exit(1);
     }
 
-    void* sharedMemPtr  = mmap(0, NUM_CHANNEL*sizeof(FileLine) + sizeof(uint8_t), PROT_READ | PROT_WRITE, MAP_SHARED, shm_fd, 0);
+    size_t sharedMemBytes = CNM_ACTIVITY_OFFSET(NUM_CHANNEL*sizeof(FileLine)) + sizeof(cnm_activity);
+    void* sharedMemPtr  = mmap(0, sharedMemBytes, PROT_READ | PROT_WRITE, MAP_SHARED, shm_fd, 0);
     if (sharedMemPtr == MAP_FAILED) {
         perror("mmap failed");
         exit(1);
     }
     FileLine* sharedCnmInfo = (FileLine*) sharedMemPtr;
     uint8_t* sharedLastCmd = ((uint8_t*) sharedMemPtr) + NUM_CHANNEL*sizeof(FileLine);
+    sharedActivity = (cnm_activity*) (((uint8_t*) sharedMemPtr) + CNM_ACTIVITY_OFFSET(NUM_CHANNEL*sizeof(FileLine)));
     deque<FileLine> instructionList[NUM_CHANNEL];
 
     // Semaphores
@@ -164,19 +197,13 @@ void cnm_driver::driver_thread() {
     wait(CLK_PERIOD / 2 + 1, RESOLUTION);
     curCycle++;
 
-#if OUTPUT_LOG
-    // Open output file
-    string fo = filename;   // Output file name, located in pim-cores folder
-    ofstream output[NUM_CHANNEL];
-    for (i = 0; i < NUM_CHANNEL; i++) {
-        output[i].open(fo + to_string(i));
-        if (!output[i].is_open())   {
-            cout << "Error when opening output file" << endl;
-            sc_stop();
-            return;
-        }
+    // Open output files, located in pim-cores folder
+    cnm_logger output;
+    if (!output.open(filename, NUM_CHANNEL, OUTPUT_LOG, DATA_TYPE, DWORDS_PER_COL*CORES_PER_PCH)) {
+        cout << "Error when opening output file" << endl;
+        sc_stop();
+        return;
     }
-#endif
 
     FileLine rcvCnmInfo[NUM_CHANNEL];
     FileLine sendCnmInfo[NUM_CHANNEL];
@@ -184,6 +211,7 @@ void cnm_driver::driver_thread() {
 
     // Simulation loop
     while (1) {
+        bool busSettled = false;    // Set once the bank channels have been let settle in this cycle
 
         // Setting default values, write to DQ and read from the buses to the PU.
         // For each channel, before semaphore synchronization
@@ -198,8 +226,13 @@ void cnm_driver::driver_thread() {
             pim_mode[i]->write(localPimMode[i]);    // Speed-up simulation of channels in memory mode
             DQ[i]->write(0);
             for (j = 0; j < CORES_PER_PCH; j++) {
+#if BANK_CHANNEL
+                even_buses[i][j]->release_host();
+                odd_buses[i][j]->release_host();
+#else
                 even_buses[i][j]->write(allzs);
                 odd_buses[i][j]->write(allzs);
+#endif
             }
 
             // Keep writing to DQ to finish GRF writing
@@ -219,12 +252,20 @@ void cnm_driver::driver_thread() {
             if (bankRead[i]) {
                 if (addrAux[i].range(BA_END, BA_END)) {
                     for (j = 0; j < CORES_PER_PCH; j++) {
+#if BANK_CHANNEL
+                        odd_buses[i][j]->drive_host(data2bankBuffer[i].front());
+#else
                         odd_buses[i][j]->write(data2bankBuffer[i].front());
+#endif
                         data2bankBuffer[i].pop_front();
                     }
                 } else {
                     for (j = 0; j < CORES_PER_PCH; j++) {
+#if BANK_CHANNEL
+                        even_buses[i][j]->drive_host(data2bankBuffer[i].front());
+#else
                         even_buses[i][j]->write(data2bankBuffer[i].front());
+#endif
                         data2bankBuffer[i].pop_front();
                     }
                 }
@@ -235,7 +276,7 @@ void cnm_driver::driver_thread() {
         if (rcvNewCmd) {
             rcvNewCmd = false;
             if (waitSemaphore) {  // Receiving commands from gem5 // NOTE assuming gem5 can only synch once per cycle
-                sem_wait(semaphore1);
+                waitGem5(semaphore1);
                 copySharedMem(rcvCnmInfo, &localLastCmd, sharedCnmInfo, sharedLastCmd);
  #ifdef DBGPRINTS
                 std::cout << "receive from gem5" << std::endl;
@@ -278,14 +319,14 @@ void cnm_driver::driver_thread() {
             // Received command is a read or a write to RF, so we don't simulate CnM and wait for next command
             if (!writeSync && !localLastCmd){  
                 rcvNewCmd = true;
-                sem_post(semaphore2);
+                postGem5(semaphore2);
                 continue;
 
             // Received command is a write to the bank, so we simulate everything so far
             } else if (!localLastCmd) {
                 if (waitSemaphore) {
-                    sem_post(semaphore2);
-                    sem_wait(semaphore1);
+                    postGem5(semaphore2);
+                    waitGem5(semaphore1);
                     waitSemaphore = false;
                 }
 
@@ -412,9 +453,13 @@ void cnm_driver::driver_thread() {
                                     for (k = 0; k < DWORDS_PER_COL; k++){
                                         data2bankAux = readData[i].front();
                                         readData[i].pop_front();
+#if BANK_CHANNEL
+                                        data2bank.word[k] = data2bankAux;
+#else
                                         data2bank.range(DQ_BITS*(k+1)-1,DQ_BITS*k) = data2bankAux;
+#endif
                                     }
-#ifdef DBGPRINTS
+#if defined(DBGPRINTS) && !(BANK_CHANNEL)
                                     cout << "parsed data to bank: " << hex << data2bank << endl;
 #endif
                                     data2bankBuffer[i].push_back(data2bank);
@@ -432,10 +477,8 @@ void cnm_driver::driver_thread() {
                             col_addr[i]->write(addrAux[i].range(CO_STA, CO_END));
                             bankWrite[i] = true;
 
-#if OUTPUT_LOG
                             // Write address here because it will be overwritten later with the next cmd
-                            output[i] << showbase << dec << curCycle << "\t" << hex << readAddr[i] << "\t";
-#endif
+                            output.record(i, curCycle, readAddr[i]);
 
                         }
                     }
@@ -443,12 +486,13 @@ void cnm_driver::driver_thread() {
             }
         } else if (localLastCmd && caughtUp) {
             // End of simulation, last command was already read
-            munmap(sharedMemPtr, NUM_CHANNEL*sizeof(FileLine) + sizeof(uint8_t));
+#if NMC_ACTIVITY
+            *sharedActivity = cnm_activity_total();
+#endif
+            munmap(sharedMemPtr, sharedMemBytes);
             shm_unlink(shmName.c_str());
             sem_post(semaphore2);
-#if OUTPUT_LOG
-            for (i = 0; i < NUM_CHANNEL; i++) { output[i].close(); }
-#endif
+            output.close();
             break;
         }
 
@@ -467,28 +511,41 @@ void cnm_driver::driver_thread() {
 #endif
 
             if (bankWrite[i]) {    // TODO translate hex to half
+#if BANK_CHANNEL
+                // All the commands of this cycle are issued, so instead of spinning on delta
+                // cycles we let the time step settle once before reading the bank channels
+                if (!busSettled) {
+                    wait(BUS_SETTLE, RESOLUTION);
+                    busSettled = true;
+                }
+#else
                 for (j = 0; j < 10; j++)    // More than one deltas are needed
                     wait(0, RESOLUTION);    // We need to wait for a delta to solve the bank buses
+#endif
                 if (addrAux[i].range(BA_END, BA_END)) {
                     for (j = 0; j < CORES_PER_PCH; j++) {
                         bankAux = odd_buses[i][j]->read();
                         for (k = 0; k < DWORDS_PER_COL; k++) {
+#if BANK_CHANNEL
+                            bank2out = bankAux.word[k];
+#else
                             bank2out = bankAux.range(DQ_BITS*(k+1)-1,DQ_BITS*k);
-                            sendCnmInfo[i].dataArray[DWORDS_PER_COL*j+k] = bank2out;
-#if OUTPUT_LOG
-                            output[i] << showbase << hex << bank2out << "\t";
 #endif
+                            sendCnmInfo[i].dataArray[DWORDS_PER_COL*j+k] = bank2out;
+                            output.data(i, bank2out);
                         }
                     }
                 } else {
                     for (j = 0; j < CORES_PER_PCH; j++) {
                         bankAux = even_buses[i][j]->read();
                         for (k = 0; k < DWORDS_PER_COL; k++) {
+#if BANK_CHANNEL
+                            bank2out = bankAux.word[k];
+#else
                             bank2out = bankAux.range(DQ_BITS*(k+1)-1,DQ_BITS*k);
-                            sendCnmInfo[i].dataArray[DWORDS_PER_COL*j+k] = bank2out;
-#if OUTPUT_LOG
-                            output[i] << showbase << hex << bank2out << "\t";
 #endif
+                            sendCnmInfo[i].dataArray[DWORDS_PER_COL*j+k] = bank2out;
+                            output.data(i, bank2out);
                         }
                     }
                 }
@@ -499,10 +556,6 @@ void cnm_driver::driver_thread() {
                 std::cout << std::endl;
  #endif
 
-#if OUTPUT_LOG
-                output[i] << endl;
-#endif
-
                 bankWrite[i] = false;
             }
         }
@@ -514,13 +567,14 @@ void cnm_driver::driver_thread() {
         }
         if(rcvNewCmd && instrListsEmpty){
             waitSemaphore = true;
-            sem_post(semaphore2);
+            postGem5(semaphore2);
         }
-        wait(CLK_PERIOD, RESOLUTION);
+        wait(CLK_PERIOD - (busSettled ? BUS_SETTLE : 0), RESOLUTION);
         curCycle++;
     }
 
     cout << "Simulation finished at cycle " << dec << curCycle << endl;
+    cout << "Host seconds waiting for gem5: " << gem5WaitSeconds << endl;
 
     // Stop simulation
     sc_stop();
@@ -0,0 +1,173 @@
+ /*
+ * Copyright EPFL 2024
+ * Rafael Medina Morillas
+ *
+ * Binary log of the bank writes observed by the CnM drivers.
+ *
+ * The driver appends records to a per-channel buffer and a background thread
+ * writes the full buffers to the .results files, so the simulation loop never
+ * formats nor flushes. Files are decoded offline with inputs/bin/decode_results.
+ *
+ * File layout: one cnm_log_header followed by fixed-size records, each one
+ * made of the cycle and the address of the bank write (uint64_t) and, at
+ * CNM_LOG_FULL, the words read from the bank buses (words_per_record uint64_t).
+ *
+ */
+
+#ifndef CNM_LOGGER_H_
+#define CNM_LOGGER_H_
+
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+// Values of OUTPUT_LOG
+#define CNM_LOG_OFF         0   // No results file
+#define CNM_LOG_SUMMARY     1   // Cycle and address of every bank write
+#define CNM_LOG_FULL        2   // Cycle, address and data of every bank write
+
+#define CNM_LOG_MAGIC       0x524d4e43  // "CNMR"
+#define CNM_LOG_VERSION     1
+
+typedef struct cnm_log_header {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t level;
+    uint32_t data_type;         // DATA_TYPE of the simulated design
+    uint32_t words_per_record;  // 64-bit words per record after cycle and address
+} cnm_log_header;
+
+class cnm_logger {
+public:
+    static const size_t BUFFER_BYTES = 1 << 20;    // Size of the buffers handed to the writer thread
+    static const size_t MAX_PENDING = 8;           // Full buffers queued before the driver blocks
+
+    cnm_logger() : level(CNM_LOG_OFF), words(0), stop(false) {}
+    ~cnm_logger() { close(); }
+
+    // Opens <basename><channel> for every channel and starts the writer thread
+    bool open(const std::string& basename, int channels, int level_, uint32_t dataType, uint32_t words_) {
+        level = level_;
+        words = (level == CNM_LOG_FULL) ? words_ : 0;
+        if (level == CNM_LOG_OFF)
+            return true;
+
+        cnm_log_header header = {CNM_LOG_MAGIC, CNM_LOG_VERSION, (uint16_t) level, dataType, words};
+        for (int i = 0; i < channels; i++) {
+            FILE* f = fopen((basename + std::to_string(i)).c_str(), "wb");
+            if (f == NULL) {
+                close();
+                return false;
+            }
+            fwrite(&header, sizeof(header), 1, f);
+            files.push_back(f);
+            buffers.push_back(std::vector<uint8_t>());
+            buffers.back().reserve(BUFFER_BYTES);
+        }
+        stop = false;
+        writer = std::thread(&cnm_logger::writer_thread, this);
+        return true;
+    }
+
+    // Starts the record of a bank write. At CNM_LOG_FULL, it must be followed by words_per_record calls to data()
+    void record(int ch, uint64_t cycle, uint64_t address) {
+        if (level == CNM_LOG_OFF)
+            return;
+        append(ch, cycle);
+        append(ch, address);
+        if (!words && buffers[ch].size() >= BUFFER_BYTES)
+            submit(ch);
+    }
+
+    void data(int ch, uint64_t word) {
+        if (level != CNM_LOG_FULL)
+            return;
+        append(ch, word);
+        if (buffers[ch].size() >= BUFFER_BYTES && (buffers[ch].size() % recordBytes()) == 0)
+            submit(ch);
+    }
+
+    // Writes the pending buffers and closes the files
+    void close() {
+        if (writer.joinable()) {
+            for (size_t i = 0; i < buffers.size(); i++) {
+                if (!buffers[i].empty())
+                    submit(i);
+            }
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                stop = true;
+            }
+            cvWriter.notify_one();
+            writer.join();
+        }
+        for (size_t i = 0; i < files.size(); i++)
+            fclose(files[i]);
+        files.clear();
+        buffers.clear();
+    }
+
+private:
+    int level;
+    uint32_t words;
+    std::vector<FILE*> files;
+    std::vector<std::vector<uint8_t> > buffers;                     // Buffer being filled, per channel
+    std::deque<std::pair<int, std::vector<uint8_t> > > pending;     // Full buffers waiting for the writer
+    std::vector<std::vector<uint8_t> > spare;                       // Written buffers, reused to avoid allocations
+    std::thread writer;
+    std::mutex mtx;
+    std::condition_variable cvWriter, cvDriver;
+    bool stop;
+
+    size_t recordBytes() const { return (2 + words) * sizeof(uint64_t); }
+
+    void append(int ch, uint64_t value) {
+        std::vector<uint8_t>& buf = buffers[ch];
+        size_t size = buf.size();
+        buf.resize(size + sizeof(value));
+        memcpy(&buf[size], &value, sizeof(value));
+    }
+
+    // Hands the buffer of the channel to the writer thread and takes a spare one
+    void submit(int ch) {
+        std::unique_lock<std::mutex> lock(mtx);
+        cvDriver.wait(lock, [this] { return pending.size() < MAX_PENDING; });
+        pending.push_back(std::make_pair(ch, std::move(buffers[ch])));
+        if (!spare.empty()) {
+            buffers[ch] = std::move(spare.back());
+            spare.pop_back();
+        } else {
+            buffers[ch] = std::vector<uint8_t>();
+            buffers[ch].reserve(BUFFER_BYTES);
+        }
+        lock.unlock();
+        cvWriter.notify_one();
+    }
+
+    void writer_thread() {
+        std::unique_lock<std::mutex> lock(mtx);
+        while (1) {
+            cvWriter.wait(lock, [this] { return stop || !pending.empty(); });
+            if (pending.empty())
+                break;
+            std::pair<int, std::vector<uint8_t> > job = std::move(pending.front());
+            pending.pop_front();
+            lock.unlock();
+            cvDriver.notify_one();
+
+            fwrite(job.second.data(), 1, job.second.size(), files[job.first]);
+            job.second.clear();
+
+            lock.lock();
+            spare.push_back(std::move(job.second));
+        }
+    }
+};
+
+#endif /* CNM_LOGGER_H_ */
@@ -14,8 +14,13 @@ int sc_main(int argc, char *argv[]) {
     sc_signal<sc_uint<ROW_BITS> >   row_addr[NUM_CHANNEL];                   // Address of the bank row
     sc_signal<sc_uint<COL_BITS> >   col_addr[NUM_CHANNEL];                   // Address of the bank column
     sc_signal<sc_uint<DQ_BITS> >    DQ[NUM_CHANNEL];                         // Data input from DRAM controller (output makes no sense
+#if BANK_CHANNEL
+    bank_channel                    even_buses[NUM_CHANNEL][CORES_PER_PCH];  // Direct data in/out to the even bank
+    bank_channel                    odd_buses[NUM_CHANNEL][CORES_PER_PCH];   // Direct data in/out to the odd bank
+#else
     sc_signal_rv<GRF_WIDTH>         even_buses[NUM_CHANNEL][CORES_PER_PCH];  // Direct data in/out to the even bank
     sc_signal_rv<GRF_WIDTH>         odd_buses[NUM_CHANNEL][CORES_PER_PCH];   // Direct data in/out to the odd bank
+#endif
 
     uint i, j;
 
@@ -109,8 +114,10 @@ int sc_main(int argc, char *argv[]) {
         sc_trace(tracefile, dut.imc_pchs[0]->imc_cores[i]->ext2grf[0], "ext2grf");
         sc_trace(tracefile, dut.imc_pchs[0]->imc_cores[i]->PC, "PC");
         sc_trace(tracefile, dut.imc_pchs[0]->imc_cores[i]->instr, "instr");
+#if !(BANK_CHANNEL)
         sc_trace(tracefile, even_buses[0][i], "even_bus");
         sc_trace(tracefile, odd_buses[0][i], "odd_bus");
+#endif
         sc_trace(tracefile, dut.imc_pchs[0]->imc_cores[i]->even2grfa[0], "even2grfa");
         sc_trace(tracefile, dut.imc_pchs[0]->imc_cores[i]->odd2grfb[0], "odd2grfb");
         sc_trace(tracefile, dut.imc_pchs[0]->imc_cores[i]->crf_wr_en, "crf_wr_en");
@@ -149,12 +156,20 @@ int sc_main(int argc, char *argv[]) {
     }
 #endif
 
+    auto hostStart = std::chrono::steady_clock::now();
     sc_start();
+    double hostSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - hostStart).count();
 
 #if !(GEM5)
     sc_close_vcd_trace_file(tracefile);
 #endif
 
+    // Host-side cost of the simulation, parsed by scripts/run_benchmark.sh
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    std::cout << "Host seconds: " << hostSeconds << std::endl;
+    std::cout << "Peak RSS (kB): " << usage.ru_maxrss << std::endl;
+
     return 0;
 }
 
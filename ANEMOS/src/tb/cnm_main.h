@@ -4,6 +4,8 @@
 #include "cnm_driver.h"
 #include "cnm_monitor.h"
 #include <string>
+#include <chrono>
+#include <sys/resource.h>
 
 #include "../cnm_device.h"  // We don't do mixed signal simulaiton at the device level
 
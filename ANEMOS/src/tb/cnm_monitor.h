@@ -2,6 +2,7 @@
 #include <bitset>
 
 #include "../cnm_base.h"
+#include "../bank_channel.h"
 
 SC_MODULE(cnm_monitor) {
 
@@ -17,8 +18,13 @@ SC_MODULE(cnm_monitor) {
     sc_in<sc_uint<ROW_BITS> >   row_addr[NUM_CHANNEL];                   // Address of the bank row
     sc_in<sc_uint<COL_BITS> >   col_addr[NUM_CHANNEL];                   // Address of the bank column
     sc_in<sc_uint<DQ_BITS> >    DQ[NUM_CHANNEL];                         // Data input from DRAM controller (output makes no sense)
+#if BANK_CHANNEL
+    sc_port<bank_bus_if>        even_buses[NUM_CHANNEL][CORES_PER_PCH];  // Direct data in/out to the even banks
+    sc_port<bank_bus_if>        odd_buses[NUM_CHANNEL][CORES_PER_PCH];   // Direct data in/out to the odd banks
+#else
     sc_inout_rv<GRF_WIDTH>      even_buses[NUM_CHANNEL][CORES_PER_PCH];  // Direct data in/out to the even banks
     sc_inout_rv<GRF_WIDTH>      odd_buses[NUM_CHANNEL][CORES_PER_PCH];   // Direct data in/out to the odd banks
+#endif
 
     // Internal events
 
@@ -5,6 +5,12 @@
 #include "imc_monitor.h"
 #include <string>
 
+// The IMC core testbench drives resolved sc_signal_rv bank buses, only the cnm
+// testbench has the transactional bank_channel ones
+#if BANK_CHANNEL
+#error "Build the IMC core testbench with BANK_CHANNEL 0 in defs.h"
+#endif
+
 #if MIXED_SIM
 #include "../imc_wrapped.h"
 #else
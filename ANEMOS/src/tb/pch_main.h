@@ -5,6 +5,12 @@
 #include "pch_monitor.h"
 #include <string>
 
+// The pseudo-channel testbench drives resolved sc_signal_rv bank buses, only the cnm
+// testbench has the transactional bank_channel ones
+#if BANK_CHANNEL
+#error "Build the pseudo-channel testbench with BANK_CHANNEL 0 in defs.h"
+#endif
+
 #if MIXED_SIM
 #if SIMD_WIDTH == 2
 #include "imc_wrapped_S2.h"
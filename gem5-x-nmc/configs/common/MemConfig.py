@@ -267,11 +267,43 @@ def config_mem(options, system):
 #If NMC-gem5-x simulation, nmc options defined when launching gem5-x. Memory type, size and start address defined too. 
     if options.nmc:
         nmc_mem_type = options.nmc_mem_type
+        nmc_parallel = getattr(options, "nmc_parallel", False)
+        nmc_slave = xbar.master
+        # The NMC memory can run on its own event queue and thread, the
+        # packets cross to and from the membus through EventQueueBridges.
+        # The simulation quantum is set on the root, see fs.py.
+        if nmc_parallel:
+            nmc_eventq = 1
+            subsystem.nmc_bridge = EventQueueBridge(
+                master_eventq_index = nmc_eventq)
+            subsystem.nmc_bridge.slave = xbar.master
+            nmc_slave = subsystem.nmc_bridge.master
         if nmc_mem_type == "SimpleMemory":
             subsystem.nmcMem = SimpleMemory(clk_domain=system.clk_domain,latency = '1ps', latency_var = '0ns', bandwidth = '512GB/s')
             subsystem.nmcMem.range = m5.objects.AddrRange(int(options.nmc_start, 16), size =  long(Addr(options.nmc_mem_size))) 
-            subsystem.nmcMem.port = xbar.master
+            subsystem.nmcMem.port = nmc_slave
         elif nmc_mem_type == "Ramulator":
             subsystem.nmcMem = Ramulator(clk_domain=system.clk_domain, config_file = options.ramulator_config)
+            subsystem.nmcMem.host_profile = bool(options.nmc_host_profile)
+            subsystem.nmcMem.write_combining = bool(options.nmc_write_combining)
+            if getattr(options, "nmc_binary", None):
+                subsystem.nmcMem.nmc.binary = options.nmc_binary
+            if getattr(options, "nmc_trace_record", None):
+                subsystem.nmcMem.trace_file = options.nmc_trace_record
+            # Sampling runs the NMC regions in detail, see Simulation.py
+            if getattr(options, "sampling_period", None):
+                subsystem.nmcMem.nmc.exit_on_mode_change = True
             subsystem.nmcMem.range = m5.objects.AddrRange(int(options.nmc_start, 16), size =  long(Addr(options.nmc_mem_size))) 
-            subsystem.nmcMem.port = xbar.master
+            subsystem.nmcMem.port = nmc_slave
+            if options.nmc_coherent_results and nmc_parallel:
+                # The invalidations cross back to the event queue of the
+                # membus, the default one of the bridge master side
+                subsystem.nmc_inv_bridge = EventQueueBridge(
+                    eventq_index = nmc_eventq)
+                subsystem.nmc_inv_bridge.master = xbar.slave
+                subsystem.nmcMem.master = subsystem.nmc_inv_bridge.slave
+            elif options.nmc_coherent_results:
+                subsystem.nmcMem.master = xbar.slave
+        if nmc_parallel:
+            # NMCcores, child of Ramulator, follows its event queue
+            subsystem.nmcMem.eventq_index = nmc_eventq
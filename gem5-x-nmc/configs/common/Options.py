@@ -259,6 +259,12 @@ def addCommonOptions(parser):
                       help="""Exit after initialization. Do not simulate time.
                               Useful when gem5 is run as a library.""")
 
+    # Statistics options
+    parser.add_option("--stats-period", action="store", type="string",
+                      help="""Dump and reset the stats periodically, every
+                              given time (e.g. 10us). Cheap enough for a
+                              timeline with --stats-file=binary://FILE""")
+
     # Simpoint options
     parser.add_option("--simpoint-profile", action="store_true",
                       help="Enable basic block profiling for SimPoints")
@@ -303,6 +309,18 @@ def addCommonOptions(parser):
     parser.add_option("-s", "--standard-switch", action="store", type="int",
         default=None,
         help="switch from timing to Detailed CPU after warmup period of <N>")
+    parser.add_option("--sampling-period", action="store", type="int",
+        default=None,
+        help="""SMARTS sampling: run --cpu-type for a sample every <N>
+                instructions and the atomic CPU, warming the caches and
+                TLBs, in between. The NMC regions always run with
+                --cpu-type. Requires --caches""")
+    parser.add_option("--sampling-warmup", action="store", type="int",
+        default=2000,
+        help="Instructions of detailed warming before each sample")
+    parser.add_option("--sampling-detail", action="store", type="int",
+        default=1000,
+        help="Instructions measured in each sample")
     parser.add_option("-p", "--prog-interval", type="str",
         help="CPU Progress Interval")
 
@@ -362,6 +380,27 @@ def addNMCCoresOptions(parser):
                       default = "10MB")
     parser.add_option("--nmc_start", type = "string",
                       default = "0x400000000")
+    parser.add_option("--nmc_host_profile", action="store_true",
+                      help = "Report the host time spent in Ramulator at exit")
+    parser.add_option("--nmc_write_combining", action="store_true",
+                      help = "Combine the stores to a GRF line, and in host "
+                      "mode to a burst of the banks, into a single write to "
+                      "Ramulator and the NMC cores")
+    parser.add_option("--nmc_coherent_results", action="store_true",
+                      help = "Invalidate the cached copies of the lines written "
+                      "by the NMC cores, so the results can be read cached")
+    parser.add_option("--nmc_parallel", action="store_true",
+                      help = "Simulate the NMC memory, Ramulator and the NMC "
+                      "cores, on its own event queue and thread")
+    parser.add_option("--nmc_sim_quantum", type = "string", default = "5ns",
+                      help = "Simulation quantum with --nmc_parallel, also "
+                      "the latency of the crossings to the NMC memory")
+    parser.add_option("--nmc_binary", type = "string", default = None,
+                      help = "SystemC model of the NMC cores (ANEMOS build) "
+                      "to run instead of ext/NMCcores/nmc-cores")
+    parser.add_option("--nmc_trace_record", type = "string", default = None,
+                      help = "Record the timing requests to the NMC memory "
+                      "to this file, to replay them with nmc_trace_replay.py")
 
 def addFSOptions(parser):
     from FSConfig import os_types
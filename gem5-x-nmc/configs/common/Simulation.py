@@ -95,6 +95,14 @@ def setCPUClass(options):
         TmpClass = AtomicSimpleCPU
         test_mem_mode = 'atomic'
 
+    # The atomic CPU runs between the samples measured with the CPU type
+    if options.sampling_period:
+        if CPUClass is None:
+            CPUClass = TmpClass
+            CPUClass2 = TmpClass2
+        TmpClass = AtomicSimpleCPU
+        test_mem_mode = 'atomic'
+
     # Ruby only supports atomic accesses in noncaching mode
     if test_mem_mode == 'atomic' and options.ruby:
         warn("Memory mode will be changed to atomic_noncaching")
@@ -445,6 +453,136 @@ def repeatSwitch(testsys, repeat_switch_cpu_list, maxtick, switch_freq):
             exit_event = m5.simulate(maxtick - m5.curTick())
             return exit_event
 
+def sampledRun(options, testsys, switch_cpu_list, maxtick):
+    """SMARTS sampling. The atomic CPUs run --sampling-period instructions
+    between the samples, warming the caches and TLBs functionally. The
+    detailed CPUs then warm up for --sampling-warmup instructions and are
+    measured for the next --sampling-detail. The NMC regions, between the
+    mode changes of the NMC cores, always run in detail.
+
+    The stats are reset at the start of each sample and NMC region, and
+    dumped at its end. The time of the whole run is extrapolated from the
+    samples to sampling.txt in the output directory."""
+
+    phase_done = "sampling phase done"
+    atomic_list = [(new, old) for old, new in switch_cpu_list]
+    atomic_cpus = [old for old, new in switch_cpu_list]
+    detailed_cpus = [new for old, new in switch_cpu_list]
+
+    def insts(cpus):
+        return sum(cpu.totalInsts() for cpu in cpus)
+
+    def stopAfter(cpus, count):
+        for cpu in cpus:
+            cpu.scheduleInstStop(0, count, phase_done)
+        return [cpu.getCurrentInstCount(0) + count for cpu in cpus]
+
+    # The stops of a phase cut short by an NMC region still fire later,
+    # they are told apart by the instruction counts
+    def reached(cpus, targets):
+        return any(cpu.getCurrentInstCount(0) >= target
+                   for cpu, target in zip(cpus, targets))
+
+    log = open(joinpath(m5.options.outdir, "sampling.txt"), "w")
+    samples = []
+    regions = []
+    # Instructions out of the NMC regions, extrapolated from the samples
+    sampled_insts = 0
+
+    phase = "functional"
+    active = atomic_cpus
+    targets = stopAfter(active, options.sampling_period)
+    phase_tick = m5.curTick()
+    phase_insts = insts(active)
+
+    print("starting sampling loop")
+    while True:
+        exit_event = m5.simulate(maxtick - m5.curTick())
+        exit_cause = exit_event.getCause()
+
+        if exit_cause == phase_done and not reached(active, targets):
+            continue
+        if exit_cause == "nmc region begin" and phase == "nmc":
+            continue
+        if exit_cause == "nmc region end" and phase != "nmc":
+            continue
+
+        ticks = m5.curTick() - phase_tick
+        count = insts(active) - phase_insts
+        if phase != "nmc":
+            sampled_insts += count
+
+        if exit_cause == "nmc region begin":
+            # a sample cut short is dropped
+            if phase == "functional":
+                m5.switchCpus(testsys, switch_cpu_list)
+                active = detailed_cpus
+            m5.stats.reset()
+            phase = "nmc"
+            targets = []
+        elif exit_cause == "nmc region end":
+            regions.append((ticks, count))
+            m5.stats.dump()
+            log.write("nmc region @ tick %d: %d ticks, %d insts\n" %
+                      (phase_tick, ticks, count))
+            m5.switchCpus(testsys, atomic_list)
+            active = atomic_cpus
+            phase = "functional"
+            targets = stopAfter(active, options.sampling_period)
+        elif exit_cause != phase_done:
+            break
+        elif phase == "functional":
+            m5.switchCpus(testsys, switch_cpu_list)
+            active = detailed_cpus
+            if options.sampling_warmup > 0:
+                phase = "warmup"
+                targets = stopAfter(active, options.sampling_warmup)
+            else:
+                m5.stats.reset()
+                phase = "detail"
+                targets = stopAfter(active, options.sampling_detail)
+        elif phase == "warmup":
+            m5.stats.reset()
+            phase = "detail"
+            targets = stopAfter(active, options.sampling_detail)
+        else:
+            samples.append((ticks, count))
+            m5.stats.dump()
+            log.write("sample @ tick %d: %d ticks, %d insts\n" %
+                      (phase_tick, ticks, count))
+            m5.switchCpus(testsys, atomic_list)
+            active = atomic_cpus
+            phase = "functional"
+            targets = stopAfter(active, options.sampling_period)
+
+        phase_tick = m5.curTick()
+        phase_insts = insts(active)
+
+    region_ticks = sum(ticks for ticks, count in regions)
+    rates = [float(ticks) / count for ticks, count in samples if count]
+    summary = ["%d insts out of the NMC regions, %d samples" %
+               (sampled_insts, len(rates)),
+               "%d NMC regions: %d ticks, %d insts" %
+               (len(regions), region_ticks,
+                sum(count for ticks, count in regions))]
+    if rates:
+        mean = sum(rates) / len(rates)
+        summary.append("%f ticks per inst out of the NMC regions" % mean)
+        if len(rates) > 1:
+            var = sum((r - mean) ** 2 for r in rates) / (len(rates) - 1)
+            # SMARTS confidence interval, 3 standard errors (99.7%)
+            summary.append("+- %.2f%% at 99.7%% confidence" %
+                           (300.0 * (var / len(rates)) ** 0.5 / mean))
+        estimate = int(sampled_insts * mean) + region_ticks
+        summary.append("estimated %d ticks (%f s)" %
+                       (estimate, estimate / float(m5.ticks.fromSeconds(1.0))))
+    for line in summary:
+        print(line)
+        log.write(line + "\n")
+    log.close()
+
+    return exit_event
+
 def run(options, root, testsys, cpu_class, cpu_class2):
     if options.checkpoint_dir:
         cptdir = options.checkpoint_dir
@@ -465,6 +603,20 @@ def run(options, root, testsys, cpu_class, cpu_class2):
     if options.repeat_switch and options.take_checkpoints:
         fatal("Can't specify both --repeat-switch and --take-checkpoints")
 
+    if options.sampling_period:
+        if not options.caches:
+            fatal("Must specify --caches when using --sampling-period")
+        if options.standard_switch or options.repeat_switch or \
+                options.fast_forward or options.take_checkpoints:
+            fatal("Can't specify --sampling-period with --standard-switch, "
+                  "--repeat-switch, --fast-forward or --take-checkpoints")
+        if cpu_class.memory_mode() != 'timing':
+            fatal("--sampling-period needs a timing --cpu-type")
+        if options.sampling_detail <= 0:
+            fatal("--sampling-detail must be positive")
+        if getattr(options, "nmc_parallel", False):
+            fatal("Can't specify both --sampling-period and --nmc_parallel")
+
     np = options.num_cpus
     switch_cpus = None
     switch_cpus2= None
@@ -708,6 +860,10 @@ def run(options, root, testsys, cpu_class, cpu_class2):
     if options.initialize_only:
         return
 
+    if options.stats_period:
+        m5.stats.periodicStatDump(m5.ticks.fromSeconds(
+            m5.util.convert.anyToLatency(options.stats_period)))
+
     # Handle the max tick settings now that tick frequency was resolved
     # during system instantiation
     # NOTE: the maxtick variable here is in absolute ticks, so it must
@@ -743,7 +899,7 @@ def run(options, root, testsys, cpu_class, cpu_class2):
         fatal("Bad maxtick (%d) specified: " \
               "Checkpoint starts starts from tick: %d", maxtick, cpt_starttick)
 
-    if options.standard_switch or cpu_class:
+    if (options.standard_switch or cpu_class) and not options.sampling_period:
         if options.standard_switch:
             print("Switch at instruction count:%s" %
                     str(testsys.cpu[0].max_insts_any_thread))
@@ -785,7 +941,10 @@ def run(options, root, testsys, cpu_class, cpu_class2):
         else:
             cptdir = getcwd()
 
-    if options.take_checkpoints != None :
+    if options.sampling_period:
+        exit_event = sampledRun(options, testsys, switch_cpu_list, maxtick)
+
+    elif options.take_checkpoints != None :
         # Checkpoints being taken via the command line at <when> and at
         # subsequent periods of <period>.  Checkpoint instructions
         # received from the benchmark running are ignored and skipped in
@@ -390,6 +390,12 @@ else:
 if options.timesync:
     root.time_sync_enable = True
 
+if options.nmc and options.nmc_parallel:
+    # The threads of the CPUs and of the NMC memory meet every quantum
+    m5.ticks.fixGlobalFrequency()
+    root.sim_quantum = m5.ticks.fromSeconds(
+        m5.util.convert.anyToLatency(options.nmc_sim_quantum))
+
 if options.frame_capture:
     VncServer.frame_capture = True
 
@@ -0,0 +1,78 @@
+#  /*
+#  * Copyright EPFL 2024
+#  * Rafael Medina Morillas
+#  *
+#  */
+
+# Replays a trace of the requests to the NMC memory, recorded with
+# --nmc_trace_record, against a Ramulator configuration and NMC cores
+# build, without the CPUs:
+#
+#   fs.py ... --nmc --nmc_trace_record=nmc.trace.gz
+#   nmc_trace_replay.py --nmc_trace=m5out/nmc.trace.gz \
+#       --ramulator-config=... --nmc_binary=...
+#
+# The player is connected to the memory through a crossbar without
+# latency, the requests were recorded at the memory port.
+
+from __future__ import print_function
+
+import optparse
+import sys
+
+import m5
+from m5.objects import *
+from m5.util import addToPath, fatal
+
+addToPath('../')
+
+from common import Options
+
+parser = optparse.OptionParser()
+Options.addCommonOptions(parser)
+Options.addNMCCoresOptions(parser)
+parser.add_option("--nmc_trace", type = "string", default = None,
+                  help = "NMC trace to replay")
+
+(options, args) = parser.parse_args()
+
+if args:
+    print("Error: script doesn't take any positional arguments")
+    sys.exit(1)
+
+if not options.nmc_trace:
+    fatal("Specify the trace to replay with --nmc_trace\n")
+
+nmc_range = AddrRange(int(options.nmc_start, 16),
+                      size = long(Addr(options.nmc_mem_size)))
+
+system = System(mem_mode = 'timing', mem_ranges = [nmc_range],
+                cache_line_size = options.cacheline_size)
+
+system.voltage_domain = VoltageDomain(voltage = options.sys_voltage)
+system.clk_domain = SrcClockDomain(clock = options.sys_clock,
+                                   voltage_domain = system.voltage_domain)
+
+system.membus = NoncoherentXBar(frontend_latency = 0, forward_latency = 0,
+                                response_latency = 0, width = 64)
+system.system_port = system.membus.slave
+
+system.nmcMem = Ramulator(config_file = options.ramulator_config,
+                          range = nmc_range)
+system.nmcMem.host_profile = bool(options.nmc_host_profile)
+system.nmcMem.write_combining = bool(options.nmc_write_combining)
+if options.nmc_binary:
+    system.nmcMem.nmc.binary = options.nmc_binary
+# Recording the replay again gives a trace to check the player against
+if options.nmc_trace_record:
+    system.nmcMem.trace_file = options.nmc_trace_record
+system.nmcMem.port = system.membus.master
+
+system.player = NMCTracePlayer(trace_file = options.nmc_trace)
+system.player.port = system.membus.slave
+
+root = Root(full_system = False, system = system)
+m5.instantiate()
+
+exit_event = m5.simulate()
+print('Exiting @ tick %i because %s' % (m5.curTick(), exit_event.getCause()))
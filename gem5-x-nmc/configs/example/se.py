@@ -126,6 +126,9 @@ def get_processes(options):
 parser = optparse.OptionParser()
 Options.addCommonOptions(parser)
 Options.addSEOptions(parser)
+Options.addSPMOptions(parser)
+# Adding NMC Memory Options
+Options.addNMCCoresOptions(parser)
 
 if '--ruby' in sys.argv:
     Ruby.define_options(parser)
@@ -169,7 +172,8 @@ else:
     sys.exit(1)
 
 
-(CPUClass, test_mem_mode, FutureClass) = Simulation.setCPUClass(options)
+(CPUClass, test_mem_mode, FutureClass, FutureClass2) = \
+    Simulation.setCPUClass(options)
 CPUClass.numThreads = numThreads
 
 # Check -- do not allow SMT with multiple CPUs
@@ -283,4 +287,4 @@ else:
     MemConfig.config_mem(options, system)
 
 root = Root(full_system = False, system = system)
-Simulation.run(options, root, system, FutureClass)
+Simulation.run(options, root, system, FutureClass, FutureClass2)
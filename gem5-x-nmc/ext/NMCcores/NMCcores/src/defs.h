@@ -31,6 +31,9 @@
 // 1: DDR4_AB
 // 2: GDDR5_AB
 // 3: LPDDR4_AB
+// 4: PCM_AB
+// 5: RRAM_AB
+// 6: STTRAM_AB
 
 #define DRAM 0
 
@@ -70,6 +73,16 @@
     #define ROW_BITS        15
     #define COL_BITS        6 //6+4
     #define GLOBAL_OFFSET   6
+#elif (DRAM >= 4 && DRAM <= 6)
+    // The NVM standards share the DDR4-like organization (4Gb_x8) at 400 MHz
+    #define CLK_PERIOD 2500
+    #define CHANNEL_BITS    0
+    #define RANK_BITS       0
+    #define BG_BITS         2
+    #define BANK_BITS       2
+    #define ROW_BITS        15
+    #define COL_BITS        7
+    #define GLOBAL_OFFSET   6
 #endif
 
 // Sizing constants
@@ -86,6 +99,9 @@
 #elif (DRAM == 3)
     #define CORES_PER_PCH   4
 	#define GRF_WIDTH		256
+#elif (DRAM >= 4 && DRAM <= 6)
+    #define CORES_PER_PCH   8
+	#define GRF_WIDTH		64
 #endif
 // #define CORES_PER_PCH   8
 // #define SIMD_WIDTH      (256 / WORD_BITS)   // Compatible with HBM interface
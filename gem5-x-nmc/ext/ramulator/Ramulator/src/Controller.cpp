@@ -7,6 +7,9 @@
 #include "DDR4_AB.h"
 #include "LPDDR4_AB.h"
 #include "GDDR5_AB.h"
+#include "PCM_AB.h"
+#include "RRAM_AB.h"
+#include "STTRAM_AB.h"
 
 using namespace ramulator;
 
@@ -31,9 +34,11 @@ static vector<int> get_offending_subarray(DRAM<SALP>* channel, vector<int> & add
 
 
 template <>
-vector<int> Controller<SALP>::get_addr_vec(SALP::Command cmd, list<Request>::iterator req){
-    if (cmd == SALP::Command::PRE_OTHER)
-        return get_offending_subarray(channel, req->addr_vec);
+const vector<int>& Controller<SALP>::get_addr_vec(SALP::Command cmd, list<Request>::iterator req){
+    if (cmd == SALP::Command::PRE_OTHER) {
+        cmd_addr_vec = get_offending_subarray(channel, req->addr_vec);
+        return cmd_addr_vec;
+    }
     else
         return req->addr_vec;
 }
@@ -65,7 +70,7 @@ void Controller<TLDRAM>::tick(){
 
     /*** 1. Serve completed reads ***/
     if (pending.size()) {
-        Request& req = pending[0];
+        Request& req = pending.front();
         if (req.depart <= clk) {
           if (req.depart - req.arrive > 1) {
                   read_latency_sum += req.depart - req.arrive;
@@ -73,7 +78,7 @@ void Controller<TLDRAM>::tick(){
                       req.addr_vec.data(), -1, clk);
           }
             req.callback(req);
-            pending.pop_front();
+            request_pool.splice(request_pool.begin(), pending, pending.begin());
         }
     }
 
@@ -158,14 +163,15 @@ void Controller<TLDRAM>::tick(){
     // set a future completion time for read requests
     if (req->type == Request::Type::READ || req->type == Request::Type::EXTENSION) {
         req->depart = clk + channel->spec->read_latency;
-        pending.push_back(*req);
+        pending.splice(pending.end(), queue->q, req);
+        return;
     }
     if (req->type == Request::Type::WRITE) {
         channel->update_serving_requests(req->addr_vec.data(), -1, clk);
     }
 
     // remove request from queue
-    queue->q.erase(req);
+    release_request(queue->q, req);
 }
 
 template<>
@@ -199,13 +205,30 @@ bool Controller<LPDDR4_AB>::enqueue(Request& req)
     return enqueue_AB(req);
 }
 
-
 template <>
 bool Controller<GDDR5_AB>::enqueue(Request& req)
 {
     return enqueue_AB(req);
 }
 
+template <>
+bool Controller<PCM_AB>::enqueue(Request& req)
+{
+    return enqueue_AB(req);
+}
+
+template <>
+bool Controller<RRAM_AB>::enqueue(Request& req)
+{
+    return enqueue_AB(req);
+}
+
+template <>
+bool Controller<STTRAM_AB>::enqueue(Request& req)
+{
+    return enqueue_AB(req);
+}
+
 template <>
 void Controller<HBM_AB>::tick(){
     tick_AB();
@@ -231,6 +254,20 @@ void Controller<GDDR5_AB>::tick(){
     tick_AB();
 }
 
+template <>
+void Controller<PCM_AB>::tick(){
+    tick_AB();
+}
+
+template <>
+void Controller<RRAM_AB>::tick(){
+    tick_AB();
+}
+
+template <>
+void Controller<STTRAM_AB>::tick(){
+    tick_AB();
+}
 
 template <>
 void RowTable<HBM_AB>::update(typename HBM_AB::Command cmd, const vector<int>& addr_vec, long clk)
@@ -263,6 +300,24 @@ void RowTable<GDDR5_AB>::update(typename GDDR5_AB::Command cmd, const vector<int
     update_AB(cmd, addr_vec, clk);
 }
 
+template <>
+void RowTable<PCM_AB>::update(typename PCM_AB::Command cmd, const vector<int>& addr_vec, long clk)
+{
+    update_AB(cmd, addr_vec, clk);
+}
+
+template <>
+void RowTable<RRAM_AB>::update(typename RRAM_AB::Command cmd, const vector<int>& addr_vec, long clk)
+{
+    update_AB(cmd, addr_vec, clk);
+}
+
+template <>
+void RowTable<STTRAM_AB>::update(typename STTRAM_AB::Command cmd, const vector<int>& addr_vec, long clk)
+{
+    update_AB(cmd, addr_vec, clk);
+}
+
 template <>
 int RowTable<HBM_AB>::get_hits(const vector<int>& addr_vec, const bool to_opened_row)
 {
@@ -293,6 +348,24 @@ int RowTable<GDDR5_AB>::get_hits(const vector<int>& addr_vec, const bool to_open
     return get_hits_AB(addr_vec, to_opened_row);
 }
 
+template <>
+int RowTable<PCM_AB>::get_hits(const vector<int>& addr_vec, const bool to_opened_row)
+{
+    return get_hits_AB(addr_vec, to_opened_row);
+}
+
+template <>
+int RowTable<RRAM_AB>::get_hits(const vector<int>& addr_vec, const bool to_opened_row)
+{
+    return get_hits_AB(addr_vec, to_opened_row);
+}
+
+template <>
+int RowTable<STTRAM_AB>::get_hits(const vector<int>& addr_vec, const bool to_opened_row)
+{
+    return get_hits_AB(addr_vec, to_opened_row);
+}
+
 template <>
 int RowTable<HBM_AB>::get_open_row(const vector<int>& addr_vec)
 {
@@ -323,4 +396,22 @@ int RowTable<GDDR5_AB>::get_open_row(const vector<int>& addr_vec)
     return get_open_row_AB(addr_vec);
 }
 
+template <>
+int RowTable<PCM_AB>::get_open_row(const vector<int>& addr_vec)
+{
+    return get_open_row_AB(addr_vec);
+}
+
+template <>
+int RowTable<RRAM_AB>::get_open_row(const vector<int>& addr_vec)
+{
+    return get_open_row_AB(addr_vec);
+}
+
+template <>
+int RowTable<STTRAM_AB>::get_open_row(const vector<int>& addr_vec)
+{
+    return get_open_row_AB(addr_vec);
+}
+
 } /* namespace ramulator */
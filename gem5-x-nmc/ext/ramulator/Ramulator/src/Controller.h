@@ -2,6 +2,7 @@
 #define __CONTROLLER_H
 
 #include <cassert>
+#include <climits>
 #include <cstdio>
 #include <deque>
 #include <fstream>
@@ -56,6 +57,22 @@ protected:
     ScalarStat write_req_queue_length_avg;
     ScalarStat write_req_queue_length_sum;
 
+    // NMC
+    ScalarStat ab_column_commands;
+    ScalarStat command_bus_cycles;
+    ScalarStat command_bus_utilization;
+
+    // DRAM energy (pJ) and power (mW) per channel, from the per-command energies of the config
+    ScalarStat act_energy;
+    ScalarStat pre_energy;
+    ScalarStat rd_energy;
+    ScalarStat wr_energy;
+    ScalarStat io_energy;
+    ScalarStat ref_energy;
+    ScalarStat background_energy;
+    ScalarStat total_energy;
+    ScalarStat average_power;
+
 #ifndef INTEGRATED_WITH_GEM5
     VectorStat record_read_hits;
     VectorStat record_read_misses;
@@ -90,9 +107,17 @@ public:
                    // after ACTIVATE w/o READ of WRITE command)
     Queue otherq;  // queue for all "other" requests (e.g., refresh)
 
-    deque<Request> pending;  // read requests that are about to receive data from DRAM
+    list<Request> pending;  // read requests that are about to receive data from DRAM
+    list<Request> request_pool;  // nodes of the served requests, reused by the queues so that they do not allocate
     bool write_mode = false;  // whether write requests should be prioritized over reads
+    bool all_banks = false;  // AllBanks standard, whose column commands reach all the banks in NMC mode
     bool wm_blocked = false;  // HBM_AB blocks write mode if requests were upgraded to activation queue
+    bool nmc_mode_switch = false;  // AllBanks: follow the mode changes of the channel instead of ordering all requests
+    bool nmc_mode = true;  // AllBanks: requests are scheduled in arrival order while the channel is in NMC mode
+    bool nmc_mode_requested = true;  // AllBanks: mode of the channel after the mode changes already enqueued
+    int pending_mode_changes = 0;  // AllBanks: mode changes enqueued but not issued yet
+    typename Scheduler<T>::Type host_scheduler = Scheduler<T>::Type::FRFCFS_PriorHit;  // AllBanks: scheduler of the host requests in memory mode
+    long next_issue = 0;  // earliest clock a queued request could issue a command, valid until a request or command changes the queues or the DRAM state
     float wr_high_watermark = 0.8f; // threshold for switching to write mode
     float wr_low_watermark = 0.2f; // threshold for switching back to read mode
     //long refreshed = 0;  // last time refresh requests were generated
@@ -103,6 +128,15 @@ public:
     bool record_cmd_trace = false;
     /* Commands to stdout */
     bool print_cmd_trace = false;
+    FILE* cmd_trace_out = stdout;  // replaced by a buffer when the channels are ticked on different threads
+
+    /* Energy per command and bank (pJ), all 0 if the config does not give them */
+    double energy_act = 0, energy_pre = 0, energy_rd = 0, energy_wr = 0;
+    double energy_io = 0;  // per column transfer through the I/O of the channel
+    double energy_ref = 0;  // per refresh of a rank
+    double power_background = 0;  // mW per channel
+    int rank_banks = 1;  // banks reached by rank-wide commands, and by every command of AllBanks standards in NMC mode
+    vector<bool> write_command;  // commands that write the column they access
 
     /* Constructor */
     Controller(const Config& configs, DRAM<T>* channel) :
@@ -114,6 +148,56 @@ public:
         cmd_trace_files(channel->children.size())
     {
         record_cmd_trace = configs.record_cmd_trace();
+
+        // Scheduling and queues. AllBanks standards always serve NMC commands in
+        // arrival order, so their scheduler only applies to host requests.
+        all_banks = channel->spec->standard_name.size() > 3 &&
+            channel->spec->standard_name.substr(channel->spec->standard_name.size() - 3) == "_AB";
+        if (configs["scheduler"] != "") {
+            auto type = scheduler->name_to_type.find(configs["scheduler"]);
+            assert(type != scheduler->name_to_type.end() && "unrecognized scheduler");
+            host_scheduler = type->second;
+            if (!all_banks)
+                scheduler->type = type->second;
+        }
+        if (configs["scheduler_cap"] != "")
+            scheduler->cap = stol(configs["scheduler_cap"]);
+        if (configs["row_policy"] != "") {
+            auto type = rowpolicy->name_to_type.find(configs["row_policy"]);
+            assert(type != rowpolicy->name_to_type.end() && "unrecognized row policy");
+            rowpolicy->type = type->second;
+        }
+        if (configs["readq_size"] != "")
+            readq.max = stoi(configs["readq_size"]);
+        if (configs["writeq_size"] != "")
+            writeq.max = stoi(configs["writeq_size"]);
+
+        // Energy model
+        if (configs["energy_act"] != "")
+            energy_act = stod(configs["energy_act"]);
+        if (configs["energy_pre"] != "")
+            energy_pre = stod(configs["energy_pre"]);
+        if (configs["energy_rd"] != "")
+            energy_rd = stod(configs["energy_rd"]);
+        if (configs["energy_wr"] != "")
+            energy_wr = stod(configs["energy_wr"]);
+        if (configs["energy_io"] != "")
+            energy_io = stod(configs["energy_io"]);
+        if (configs["energy_ref"] != "")
+            energy_ref = stod(configs["energy_ref"]);
+        if (configs["power_background"] != "")
+            power_background = stod(configs["power_background"]);
+        for (int lev = int(T::Level::Rank) + 1; lev < int(T::Level::Row); lev++)
+            rank_banks *= channel->spec->org_entry.count[lev];
+        for (int c = 0; c < int(T::Command::MAX); c++)
+            write_command.push_back(channel->spec->command_name[c].compare(0, 2, "WR") == 0);
+
+        // Channels start in memory mode when the mode changes of gem5 are followed
+        if (configs["nmc_mode_switch"] == "on") {
+            nmc_mode_switch = true;
+            nmc_mode_requested = false;
+            set_nmc_mode(false);
+        }
         print_cmd_trace = configs.print_cmd_trace();
         if (record_cmd_trace){
             if (configs["cmd_trace_prefix"] != "") {
@@ -242,6 +326,68 @@ public:
             .precision(6)
             ;
 
+        ab_column_commands
+            .name("ab_column_commands_"+to_string(channel->id))
+            .desc("Column commands issued to all the banks while the channel is in NMC mode per channel.")
+            .precision(0)
+            ;
+        command_bus_cycles
+            .name("command_bus_cycles_"+to_string(channel->id))
+            .desc("Memory cycles in which the command bus carried a command per channel.")
+            .precision(0)
+            ;
+        command_bus_utilization
+            .name("command_bus_utilization_"+to_string(channel->id))
+            .desc("Fraction of memory cycles in which the command bus carried a command per channel.")
+            .precision(6)
+            ;
+
+        act_energy
+            .name("act_energy_"+to_string(channel->id))
+            .desc("Energy of the activations (pJ) per channel.")
+            .precision(0)
+            ;
+        pre_energy
+            .name("pre_energy_"+to_string(channel->id))
+            .desc("Energy of the precharges (pJ) per channel.")
+            .precision(0)
+            ;
+        rd_energy
+            .name("rd_energy_"+to_string(channel->id))
+            .desc("Energy of the column reads in the banks (pJ) per channel.")
+            .precision(0)
+            ;
+        wr_energy
+            .name("wr_energy_"+to_string(channel->id))
+            .desc("Energy of the column writes in the banks (pJ) per channel.")
+            .precision(0)
+            ;
+        io_energy
+            .name("io_energy_"+to_string(channel->id))
+            .desc("Energy of the column transfers through the I/O (pJ) per channel.")
+            .precision(0)
+            ;
+        ref_energy
+            .name("ref_energy_"+to_string(channel->id))
+            .desc("Energy of the refreshes (pJ) per channel.")
+            .precision(0)
+            ;
+        background_energy
+            .name("background_energy_"+to_string(channel->id))
+            .desc("Background energy (pJ) per channel.")
+            .precision(0)
+            ;
+        total_energy
+            .name("total_energy_"+to_string(channel->id))
+            .desc("Total energy (pJ) per channel.")
+            .precision(0)
+            ;
+        average_power
+            .name("average_power_"+to_string(channel->id))
+            .desc("Average power (mW) per channel.")
+            .precision(4)
+            ;
+
 #ifndef INTEGRATED_WITH_GEM5
         record_read_hits
             .init(configs.get_core_num())
@@ -292,11 +438,24 @@ public:
         cmd_trace_files.clear();
     }
 
+    // Derives the averages from the counters, it may be called at every stats
+    // dump so that they cover the same period as the counters
     void finish(long read_req, long dram_cycles) {
-      read_latency_avg = read_latency_sum.value() / read_req;
-      req_queue_length_avg = req_queue_length_sum.value() / dram_cycles;
-      read_req_queue_length_avg = read_req_queue_length_sum.value() / dram_cycles;
-      write_req_queue_length_avg = write_req_queue_length_sum.value() / dram_cycles;
+      if (read_req)
+        read_latency_avg = read_latency_sum.value() / read_req;
+      if (dram_cycles) {
+        req_queue_length_avg = req_queue_length_sum.value() / dram_cycles;
+        read_req_queue_length_avg = read_req_queue_length_sum.value() / dram_cycles;
+        write_req_queue_length_avg = write_req_queue_length_sum.value() / dram_cycles;
+        command_bus_utilization = command_bus_cycles.value() / dram_cycles;
+      }
+      // mW times ns gives pJ
+      double ns = dram_cycles * channel->spec->speed_entry.tCK;
+      background_energy = power_background * ns;
+      total_energy = act_energy.value() + pre_energy.value() + rd_energy.value() + wr_energy.value() +
+                     io_energy.value() + ref_energy.value() + background_energy.value();
+      if (dram_cycles)
+        average_power = total_energy.value() / ns;
       // call finish function of each channel
       channel->finish(dram_cycles);
     }
@@ -312,20 +471,25 @@ public:
     }
 
     bool enqueue(Request& req)
+    {
+        return enqueue_mem(req);
+    }
+
+    bool enqueue_mem(Request& req)
     {
         Queue& queue = get_queue(req.type);
         if (queue.max == queue.size())
             return false;
 
         req.arrive = clk;
-        queue.q.push_back(req);
+        push_request(queue, req);
+        next_issue = 0;
         // shortcut for read requests, if a write to same addr exists
         // necessary for coherence
         if (req.type == Request::Type::READ && find_if(writeq.q.begin(), writeq.q.end(),
-                [req](Request& wreq){ return req.addr == wreq.addr;}) != writeq.q.end()){
-            req.depart = clk + 1;
-            pending.push_back(req);
-            readq.q.pop_back();
+                [&req](Request& wreq){ return req.addr == wreq.addr;}) != writeq.q.end()){
+            readq.q.back().depart = clk + 1;
+            pending.splice(pending.end(), readq.q, prev(readq.q.end()));
         }
         return true;
     }
@@ -335,8 +499,26 @@ public:
         if (queue.max == queue.size())
             return false;
 
+        // An access to the mode-change address of the channel toggles its mode.
+        // NMC mode starts as soon as it is enqueued, so the commands after it keep
+        // their order, and ends when the last queued mode change is issued.
+        if (nmc_mode_switch && is_mode_change(req)) {
+            nmc_mode_requested = !nmc_mode_requested;
+            pending_mode_changes++;
+            if (nmc_mode_requested && !nmc_mode)
+                set_nmc_mode(true);
+            req.arrive = clk;
+            push_request(queue, req);
+            next_issue = 0;
+            return true;
+        }
+
+        if (!nmc_mode)
+            return enqueue_mem(req);
+
         req.arrive = clk;
-        queue.q.push_back(req);
+        push_request(queue, req);
+        next_issue = 0;
 
         // AllBanks memories ensure command order, so not needed to control RD after WR hazards
 
@@ -344,6 +526,11 @@ public:
     }
 
     void tick()
+    {
+        tick_mem();
+    }
+
+    void tick_mem()
     {
         clk++;
         req_queue_length_sum += readq.size() + writeq.size() + pending.size();
@@ -352,7 +539,7 @@ public:
 
         /*** 1. Serve completed reads ***/
         if (pending.size()) {
-            Request& req = pending[0];
+            Request& req = pending.front();
             if (req.depart <= clk) {
                 if (req.depart - req.arrive > 1) { // this request really accessed a row
                   read_latency_sum += req.depart - req.arrive;
@@ -360,7 +547,7 @@ public:
                       req.addr_vec.data(), -1, clk);
                 }
                 req.callback(req);
-                pending.pop_front();
+                request_pool.splice(request_pool.begin(), pending, pending.begin());
             }
         }
 
@@ -379,6 +566,11 @@ public:
                 write_mode = false;
         }
 
+        // No command can be issued before next_issue, the write mode is still
+        // updated every cycle as the watermarks may make it toggle
+        if (clk < next_issue)
+            return;
+
         /*** 4. Find the best command to schedule, if any ***/
 
         // First check the actq (which has higher priority) to see if there
@@ -416,6 +608,8 @@ public:
             vector<int> victim = rowpolicy->get_victim(cmd);
             if (!victim.empty()){
                 issue_cmd(cmd, victim);
+            } else {
+                next_issue = get_next_issue();
             }
             return;  // nothing more to be done this cycle
         }
@@ -462,8 +656,7 @@ public:
         if (cmd != channel->spec->translate[int(req->type)]) {
             if(channel->spec->is_opening(cmd)) {
                 // promote the request that caused issuing activation to actq
-                actq.q.push_back(*req);
-                queue->q.erase(req);
+                actq.q.splice(actq.q.end(), queue->q, req);
             }
 
             return;
@@ -472,7 +665,6 @@ public:
         // set a future completion time for read requests
         if (req->type == Request::Type::READ) {
             req->depart = clk + channel->spec->read_latency;
-            pending.push_back(*req);
         }
 
         if (req->type == Request::Type::WRITE) {
@@ -480,11 +672,23 @@ public:
             req->callback(*req);
         }
 
-        // remove request from queue
-        queue->q.erase(req);
+        if (pending_mode_changes && is_mode_change(*req))
+            mode_change_issued();
+
+        // remove request from queue, reads wait in pending for their data
+        if (req->type == Request::Type::READ)
+            pending.splice(pending.end(), queue->q, req);
+        else
+            release_request(queue->q, req);
     }
 
     void tick_AB(){
+        // In memory mode, host requests are scheduled as for any other memory
+        if (!nmc_mode) {
+            tick_mem();
+            return;
+        }
+
         clk++;
         req_queue_length_sum += readq.size() + writeq.size() + pending.size();
         read_req_queue_length_sum += readq.size() + pending.size();
@@ -492,7 +696,7 @@ public:
 
         /*** 1. Serve completed reads ***/
         if (pending.size()) {
-            Request& req = pending[0];
+            Request& req = pending.front();
             if (req.depart <= clk) {
                 if (req.depart - req.arrive > 1) { // this request really accessed a row
                     read_latency_sum += req.depart - req.arrive;
@@ -500,7 +704,7 @@ public:
                         req.addr_vec.data(), -1, clk);
                 }
                 req.callback(req);
-                pending.pop_front();
+                request_pool.splice(request_pool.begin(), pending, pending.begin());
             }
         }
 
@@ -518,6 +722,11 @@ public:
             }
         }
 
+        // No command can be issued before next_issue, the write mode is still
+        // updated every cycle as the watermarks may make it toggle
+        if (clk < next_issue)
+            return;
+
         /*** 4. Find the best command to schedule, if any ***/
 
         // First check the actq (which has higher priority) to see if there
@@ -557,6 +766,8 @@ public:
             vector<int> victim = rowpolicy->get_victim(cmd);
             if (!victim.empty()){
                 issue_cmd(cmd, victim);
+            } else {
+                next_issue = get_next_issue();
             }
             return;  // nothing more to be done this cycle
         }
@@ -603,8 +814,7 @@ public:
         if (cmd != channel->spec->translate[int(req->type)]) {
             if(channel->spec->is_opening(cmd)) {
                 // promote the request that caused issuing activation to actq
-                actq.q.push_back(*req);
-                queue->q.erase(req);
+                actq.q.splice(actq.q.end(), queue->q, req);
                 // AllBanks: added for maintaining order
                 if (req->type == Request::Type::READ) {
                     write_mode = false;
@@ -622,7 +832,6 @@ public:
         // set a future completion time for read requests
         if (req->type == Request::Type::READ) {
             req->depart = clk + channel->spec->read_latency;
-            pending.push_back(*req);
         }
 
         if (req->type == Request::Type::WRITE) {
@@ -630,8 +839,14 @@ public:
             req->callback(*req);
         }
 
-        // remove request from queue
-        queue->q.erase(req);
+        if (pending_mode_changes && is_mode_change(*req))
+            mode_change_issued();
+
+        // remove request from queue, reads wait in pending for their data
+        if (req->type == Request::Type::READ)
+            pending.splice(pending.end(), queue->q, req);
+        else
+            release_request(queue->q, req);
 
         // AllBanks: added for maintaining cmd order
         // If both queues have elements, order by arrival time
@@ -683,6 +898,72 @@ public:
         return channel->check_row_open(cmd, addr_vec.data());
     }
 
+    // Mode-change address of the channel: last column of the last row of the last bank
+    bool is_mode_change(const Request& req)
+    {
+        return is_mode_change(req.addr_vec);
+    }
+
+    bool is_mode_change(const vector<int>& addr_vec)
+    {
+        int *sz = channel->spec->org_entry.count;
+        int column = int(T::Level::MAX) - 1;
+        for (int lvl = int(T::Level::Channel) + 1; lvl < column; lvl++)
+            if (addr_vec[lvl] != sz[lvl] - 1)
+                return false;
+        return addr_vec[column] == sz[column] / channel->spec->prefetch_size - 1;
+    }
+
+    // AllBanks: NMC commands are served in arrival order (FCFS), host requests
+    // with the configured scheduler (FR-FCFS with row-hit priority by default)
+    void set_nmc_mode(bool mode)
+    {
+        nmc_mode = mode;
+        next_issue = 0;
+        wm_blocked = false;
+        scheduler->type = mode ? Scheduler<T>::Type::FCFS : host_scheduler;
+    }
+
+    // Mode change accessed atomically, without going through the queues. It
+    // takes effect at once, unless mode changes are still queued.
+    void atomic_mode_change()
+    {
+        nmc_mode_requested = !nmc_mode_requested;
+        if (nmc_mode_requested && !nmc_mode)
+            set_nmc_mode(true);
+        else if (!nmc_mode_requested && !pending_mode_changes)
+            set_nmc_mode(false);
+    }
+
+    void mode_change_issued()
+    {
+        pending_mode_changes--;
+        if (!pending_mode_changes && !nmc_mode_requested)
+            set_nmc_mode(false);
+    }
+
+    // Earliest clock when a command of a queued request can be issued. With FCFS
+    // only the heads of the queues can be scheduled. Speculative precharges of the
+    // closed and timeout row policies are not tracked, so they never skip cycles.
+    long get_next_issue()
+    {
+        if (rowpolicy->type != RowPolicy<T>::Type::Opened)
+            return clk + 1;
+
+        long next_clk = LONG_MAX;
+        for (Queue* queue : {&actq, &readq, &writeq, &otherq}) {
+            if (scheduler->type == Scheduler<T>::Type::FCFS) {
+                auto req = scheduler->get_head(queue->q);
+                if (req != queue->q.end())
+                    next_clk = min(next_clk, get_next(req));
+            } else {
+                for (auto req = queue->q.begin(); req != queue->q.end(); req++)
+                    next_clk = min(next_clk, get_next(req));
+            }
+        }
+        return next_clk;
+    }
+
     void update_temp(ALDRAM::Temp current_temperature)
     {
     }
@@ -723,6 +1004,29 @@ private:
         return channel->decode(cmd, req->addr_vec.data());
     }
 
+    // Queues the request in a node of the pool, only allocating when it is empty
+    void push_request(Queue& queue, const Request& req)
+    {
+        if (request_pool.empty()) {
+            queue.q.push_back(req);
+            return;
+        }
+        queue.q.splice(queue.q.end(), request_pool, request_pool.begin());
+        queue.q.back() = req;
+    }
+
+    void release_request(list<Request>& q, list<Request>::iterator req)
+    {
+        request_pool.splice(request_pool.begin(), q, req);
+    }
+
+    // Earliest clock when the first command of the request can be issued
+    long get_next(list<Request>::iterator req)
+    {
+        typename T::Command cmd = get_first_cmd(req);
+        return channel->get_next(cmd, get_addr_vec(cmd, req).data());
+    }
+
     // upgrade to an autoprecharge command
     void cmd_issue_autoprecharge(typename T::Command& cmd,
                                             const vector<int>& addr_vec) {
@@ -773,11 +1077,41 @@ private:
 
     }
 
+    // In NMC mode the commands of AllBanks standards act on all the banks of the
+    // rank, and their columns stay in the device instead of crossing the I/O
+    void account_energy(typename T::Command cmd)
+    {
+        bool ab = all_banks && nmc_mode;
+        bool rank_wide = channel->spec->scope[int(cmd)] == T::Level::Rank;
+        int banks = (ab || rank_wide) ? rank_banks : 1;
+
+        if (channel->spec->is_opening(cmd))
+            act_energy += energy_act * banks;
+        if (channel->spec->is_closing(cmd))
+            pre_energy += energy_pre * banks;
+        if (channel->spec->is_accessing(cmd)) {
+            if (write_command[int(cmd)])
+                wr_energy += energy_wr * banks;
+            else
+                rd_energy += energy_rd * banks;
+            if (!ab)
+                io_energy += energy_io;
+        }
+        if (channel->spec->is_refreshing(cmd))
+            ref_energy += rank_wide ? energy_ref : energy_ref / rank_banks;
+    }
+
     void issue_cmd(typename T::Command cmd, const vector<int>& addr_vec)
     {
         cmd_issue_autoprecharge(cmd, addr_vec);
         assert(is_ready(cmd, addr_vec));
         channel->update(cmd, addr_vec.data(), clk);
+        next_issue = 0;
+
+        ++command_bus_cycles;
+        if (all_banks && nmc_mode && channel->spec->is_accessing(cmd))
+            ++ab_column_commands;
+        account_energy(cmd);
 
         if(cmd == T::Command::PRE){
             if(rowtable->get_hits(addr_vec, true) == 0){
@@ -802,19 +1136,21 @@ private:
             }
         }
         if (print_cmd_trace){
-            printf("%5s %10ld:", channel->spec->command_name[int(cmd)].c_str(), clk);
+            fprintf(cmd_trace_out, "%5s %10ld:", channel->spec->command_name[int(cmd)].c_str(), clk);
             for (int lev = 0; lev < int(T::Level::MAX); lev++)
-                printf(" %5d", addr_vec[lev]);
-            printf("\n");
+                fprintf(cmd_trace_out, " %5d", addr_vec[lev]);
+            fprintf(cmd_trace_out, "\n");
         }
     }
-    vector<int> get_addr_vec(typename T::Command cmd, list<Request>::iterator req){
+    vector<int> cmd_addr_vec;  // address of commands that do not target their request, see get_addr_vec
+
+    const vector<int>& get_addr_vec(typename T::Command cmd, list<Request>::iterator req){
         return req->addr_vec;
     }
 };
 
 template <>
-vector<int> Controller<SALP>::get_addr_vec(
+const vector<int>& Controller<SALP>::get_addr_vec(
     SALP::Command cmd, list<Request>::iterator req);
 
 template <>
@@ -845,6 +1181,15 @@ bool Controller<LPDDR4_AB>::enqueue(Request& req);
 template <>
 bool Controller<GDDR5_AB>::enqueue(Request& req);
 
+template <>
+bool Controller<PCM_AB>::enqueue(Request& req);
+
+template <>
+bool Controller<RRAM_AB>::enqueue(Request& req);
+
+template <>
+bool Controller<STTRAM_AB>::enqueue(Request& req);
+
 template <>
 void Controller<HBM_AB>::tick();
 
@@ -860,6 +1205,15 @@ void Controller<LPDDR4_AB>::tick();
 template <>
 void Controller<GDDR5_AB>::tick();
 
+template <>
+void Controller<PCM_AB>::tick();
+
+template <>
+void Controller<RRAM_AB>::tick();
+
+template <>
+void Controller<STTRAM_AB>::tick();
+
 } /*namespace ramulator*/
 
 #endif /*__CONTROLLER_H*/
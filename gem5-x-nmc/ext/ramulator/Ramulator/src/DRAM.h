@@ -174,7 +174,8 @@ void DRAM<T>::finish(long dram_cycles) {
   busy_cycles = active_cycles.value() + refresh_cycles.value() - active_refresh_overlap_cycles.value();
 
   // finalize average serving requests
-  average_serving_requests = serving_requests.value() / dram_cycles;
+  if (dram_cycles)
+    average_serving_requests = serving_requests.value() / dram_cycles;
 
   if (!children.size()) {
     return;
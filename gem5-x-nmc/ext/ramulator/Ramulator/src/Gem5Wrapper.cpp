@@ -19,6 +19,9 @@
 #include "HBM_AB.h"
 #include "HBM2.h"
 #include "HBM2_AB.h"
+#include "PCM_AB.h"
+#include "RRAM_AB.h"
+#include "STTRAM_AB.h"
 #include "SALP.h"
 
 using namespace ramulator;
@@ -30,6 +33,7 @@ static map<string, function<MemoryBase *(const Config&, int)> > name_to_func = {
     {"WideIO", &MemoryFactory<WideIO>::create}, {"WideIO2", &MemoryFactory<WideIO2>::create},
     {"HBM", &MemoryFactory<HBM>::create}, {"HBM_AB", &MemoryFactory<HBM_AB>::create},
     {"HBM2", &MemoryFactory<HBM2>::create}, {"HBM2_AB", &MemoryFactory<HBM2_AB>::create},
+    {"PCM_AB", &MemoryFactory<PCM_AB>::create}, {"RRAM_AB", &MemoryFactory<RRAM_AB>::create}, {"STTRAM_AB", &MemoryFactory<STTRAM_AB>::create},
     {"SALP-1", &MemoryFactory<SALP>::create}, {"SALP-2", &MemoryFactory<SALP>::create}, {"SALP-MASA", &MemoryFactory<SALP>::create},
 };
 
@@ -52,7 +56,7 @@ void Gem5Wrapper::tick()
     mem->tick();
 }
 
-bool Gem5Wrapper::send(Request req)
+bool Gem5Wrapper::send(Request& req)
 {
     return mem->send(req);
 }
@@ -67,3 +71,21 @@ unsigned int Gem5Wrapper::rdqueuesize(void) {
 unsigned int Gem5Wrapper::wrqueuesize(void) {
     return mem->wrqueuesize();
 }
+int Gem5Wrapper::num_channels(void) {
+    return mem->num_channels();
+}
+int Gem5Wrapper::channel(long addr) {
+    return mem->channel(addr);
+}
+unsigned int Gem5Wrapper::rdqueuesize(int channel) {
+    return mem->rdqueuesize(channel);
+}
+unsigned int Gem5Wrapper::wrqueuesize(int channel) {
+    return mem->wrqueuesize(channel);
+}
+long Gem5Wrapper::atomic_latency(long addr, bool write, long clk) {
+    return mem->atomic_latency(addr, write, clk);
+}
+bool Gem5Wrapper::atomic_mode_change(long addr) {
+    return mem->atomic_mode_change(addr);
+}
@@ -22,10 +22,16 @@ public:
     Gem5Wrapper(const Config& configs, int cacheline);
     ~Gem5Wrapper();
     void tick();
-    bool send(Request req);
+    bool send(Request& req);
     void finish(void);
     unsigned int rdqueuesize();
     unsigned int wrqueuesize();
+    int num_channels();
+    int channel(long addr);
+    unsigned int rdqueuesize(int channel);
+    unsigned int wrqueuesize(int channel);
+    long atomic_latency(long addr, bool write, long clk);
+    bool atomic_mode_change(long addr);
 };
 
 } /*namespace ramulator*/
@@ -11,6 +11,8 @@
 #include <stdlib.h>
 #include <functional>
 #include <map>
+#include <atomic>
+#include <thread>
 
 /* Standards */
 #include "Gem5Wrapper.h"
@@ -85,12 +87,126 @@ void run_dramtrace(const Config& configs, Memory<T, Controller>& memory, const c
 
 }
 
+// Runs fn(channel) for every channel on the given number of threads
+static void for_each_channel(int channels, int threads, const function<void(int)>& fn) {
+    atomic<int> next(0);
+    vector<thread> workers;
+    for (int i = 0; i < threads; i++) {
+        workers.push_back(thread([&]() {
+            for (int ch = next++; ch < channels; ch = next++)
+                fn(ch);
+        }));
+    }
+    for (auto& worker : workers)
+        worker.join();
+}
+
+/* Same as run_dramtrace with the channels ticked on several threads. Each
+   request is still sent at its position in the trace, but a full channel only
+   delays its own requests instead of all the following ones, so the results
+   only differ from run_dramtrace when the queue of a channel fills up. The
+   channels run on their own until all their requests are served, and are then
+   ticked together until all of them are empty. */
+template <typename T>
+void run_dramtrace_parallel(const Config& configs, Memory<T, Controller>& memory, const char* tracename, int threads) {
+
+    /* split the trace by channel */
+    Trace trace(tracename);
+    struct TraceRequest {
+        long index;
+        long addr;
+        Request::Type type;
+    };
+    int channels = memory.num_channels();
+    vector<vector<TraceRequest>> requests(channels);
+    long addr = 0, total = 0;
+    Request::Type type = Request::Type::READ;
+    while (trace.get_dramtrace_request(addr, type))
+        requests[memory.channel(addr)].push_back({total++, addr, type});
+
+    /* the commands of each channel are buffered and then printed in cycle order */
+    vector<char*> cmds(channels, NULL);
+    vector<size_t> cmds_size(channels, 0);
+    for (int ch = 0; ch < channels; ch++)
+        memory.ctrls[ch]->cmd_trace_out = open_memstream(&cmds[ch], &cmds_size[ch]);
+
+    /* run simulation */
+    for_each_channel(channels, threads, [&](int ch) {
+        Request req(0, Request::Type::READ, [](Request& r){});
+        auto& reqs = requests[ch];
+        unsigned int next = 0;
+        long stalls = 0;
+        for (long clk = 0; next < reqs.size() || clk <= total + stalls || memory.pending_requests(ch); clk++) {
+            if (next < reqs.size()) {
+                if (clk >= reqs[next].index + stalls) {
+                    req.addr = reqs[next].addr;
+                    req.type = reqs[next].type;
+                    if (memory.send_channel(req))
+                        next++;
+                    else
+                        stalls++;
+                }
+            }
+            else if (clk >= total + stalls) {
+                memory.ctrls[ch]->set_high_writeq_watermark(0.0f);
+            }
+            memory.tick_channel(ch);
+        }
+    });
+    long clks = 0;
+    for (int ch = 0; ch < channels; ch++)
+        clks = max(clks, memory.channel_cycles(ch));
+    for_each_channel(channels, threads, [&](int ch) {
+        while (memory.channel_cycles(ch) < clks)
+            memory.tick_channel(ch);
+    });
+    memory.merge_channel_ticks();
+
+    vector<const char*> line(channels);
+    for (int ch = 0; ch < channels; ch++) {
+        fclose(memory.ctrls[ch]->cmd_trace_out);
+        memory.ctrls[ch]->cmd_trace_out = stdout;
+        line[ch] = cmds[ch];
+    }
+    while (true) {
+        int first = -1;
+        long first_clk = 0;
+        for (int ch = 0; ch < channels; ch++) {
+            if (!*line[ch])
+                continue;
+            long clk = strtol(line[ch] + 6, NULL, 10);  // "%5s %10ld:"
+            if (first == -1 || clk < first_clk) {
+                first = ch;
+                first_clk = clk;
+            }
+        }
+        if (first == -1)
+            break;
+        const char* end = strchr(line[first], '\n');
+        fwrite(line[first], 1, end - line[first] + 1, stdout);
+        line[first] = end + 1;
+    }
+    for (int ch = 0; ch < channels; ch++)
+        free(cmds[ch]);
+
+    while (memory.pending_requests()) {
+        memory.tick();
+        clks++;
+    }
+    Stats::curTick += clks;
+
+    // This a workaround for statistics set only initially lost in the end
+    memory.finish();
+    Stats::statlist.printall();
+}
+
 template <typename T>
 void run_cputrace(const Config& configs, Memory<T, Controller>& memory, const std::vector<const char *>& files)
 {
     int cpu_tick = configs.get_cpu_tick();
     int mem_tick = configs.get_mem_tick();
-    auto send = bind(&Memory<T, Controller>::send, &memory, placeholders::_1);
+    // the caches hand the requests by value, Memory::send maps them in place
+    auto send = [&memory](Request req) { return memory.send(req); };
     Processor proc(configs, files, send, memory);
 
     long warmup_insts = configs.get_warmup_insts();
@@ -177,7 +293,11 @@ void start_run(const Config& configs, T* spec, const vector<const char*>& files)
   if (configs["trace_type"] == "CPU") {
     run_cputrace(configs, memory, files);
   } else if (configs["trace_type"] == "DRAM") {
-    run_dramtrace(configs, memory, files[0]);
+    int threads = configs["channel_threads"] != "" ? stoi(configs["channel_threads"]) : 1;
+    if (threads > 1 && C > 1)
+      run_dramtrace_parallel(configs, memory, files[0], min(threads, C));
+    else
+      run_dramtrace(configs, memory, files[0]);
   }
 }
 
@@ -18,15 +18,16 @@ Current Memory Scheduling Policies:
 3) FRFCFS_Cap - First Ready First Come First Serve Cap
        This scheduling policy behaves the same way as FRFCS, except that it has
        a cap on the number of hits you can get in a certain row. The CAP VALUE
-       can be altered by changing the number for the "cap" variable in 
-       line number 76. 
+       can be set with the "scheduler_cap" key of the config file (16 by
+       default). 
 
 4) FRFCFS_PriorHit - First Ready First Come First Serve Prioritize Hits
        This scheduling policy behaves the same way as FRFCFS, except that it
        prioritizes row hits more than readiness. 
 
-You can select which scheduler you want to use by changing the value of 
-"type" variable on line number 74.
+You can select which scheduler you want to use with the "scheduler" key of
+the config file (FCFS by default). The row policy is selected with the
+"row_policy" key (Opened by default).
 
                 _______________________________________
 
@@ -52,6 +53,9 @@ Current Row Policies:
 #include "DDR4_AB.h"
 #include "LPDDR4_AB.h"
 #include "GDDR5_AB.h"
+#include "PCM_AB.h"
+#include "RRAM_AB.h"
+#include "STTRAM_AB.h"
 #include "Request.h"
 #include "Controller.h"
 #include <vector>
@@ -76,142 +80,165 @@ public:
 
     enum class Type {
         FCFS, FRFCFS, FRFCFS_Cap, FRFCFS_PriorHit, MAX
-    } type = Type::FCFS; //Change this line to change scheduling policy
+    } type = Type::FCFS; // Default scheduling policy, set with the scheduler key of the config
 
-    long cap = 16; //Change this line to change cap
+    map<string, Type> name_to_type = {
+        {"FCFS", Type::FCFS},
+        {"FRFCFS", Type::FRFCFS},
+        {"FRFCFS_Cap", Type::FRFCFS_Cap},
+        {"FRFCFS_PriorHit", Type::FRFCFS_PriorHit},
+    };
+
+    long cap = 16; // Default cap, set with the scheduler_cap key of the config
 
     Scheduler(Controller<T>* ctrl) : ctrl(ctrl) {}
 
     list<Request>::iterator get_head(list<Request>& q)
     {
-        // TODO make the decision at compile time
-        if (type != Type::FRFCFS_PriorHit) {
-            //If queue is empty, return end of queue
-            if (!q.size())
-                return q.end();
+        //If queue is empty, return end of queue
+        if (!q.size())
+            return q.end();
 
-            //Else return based on the policy
+        if (type == Type::FCFS) {
             auto head = q.begin();
             for (auto itr = next(q.begin(), 1); itr != q.end(); itr++)
-                head = compare[int(type)](head, itr);
+                head = compare_fcfs(head, itr);
 
             return head;
-        } 
-        else { //Code to get around edge cases for FRFCFS_PriorHit
-            
-       //If queue is empty, return end of queue
-            if (!q.size())
-                return q.end();
-
-       //Else return based on FRFCFS_PriorHit Scheduling Policy
-            auto head = q.begin();
-            for (auto itr = next(q.begin(), 1); itr != q.end(); itr++) {
-                head = compare[int(Type::FRFCFS_PriorHit)](head, itr);
-            }
+        }
 
-            if (this->ctrl->is_ready(head) && this->ctrl->is_row_hit(head)) {
-                return head;
-            }
+        index_rows(q);
 
-            // prepare a list of hit request
-            vector<vector<int>> hit_reqs;
-            for (auto itr = q.begin() ; itr != q.end() ; ++itr) {
-                if (this->ctrl->is_row_hit(itr)) {
-                    auto begin = itr->addr_vec.begin();
-                    // TODO Here it assumes all DRAM standards use PRE to close a row
-                    // It's better to make it more general.
-                    auto end = begin + int(ctrl->channel->spec->scope[int(T::Command::PRE)]) + 1;
-                    vector<int> rowgroup(begin, end); // bank or subarray
-                    hit_reqs.push_back(rowgroup);
-                }
-            }
-            // if we can't find proper request, we need to return q.end(),
-            // so that no command will be scheduled
-            head = q.end();
-            for (auto itr = q.begin(); itr != q.end(); itr++) {
+        if (type != Type::FRFCFS_PriorHit) {
+            // oldest of the ready requests, or of all if none is ready
+            RowGroup* head = &groups[0];
+            for (auto& group : groups)
+                if (group.ready != head->ready ? group.ready : older(group, *head))
+                    head = &group;
+
+            return head->oldest;
+        }
+
+        //Else return based on FRFCFS_PriorHit Scheduling Policy
+        RowGroup* head = nullptr;
+        for (auto& group : groups) {
+            if (group.ready && group.hit && (!head || older(group, *head)))
+                head = &group;
+        }
+        if (head)
+            return head->oldest;
+
+        // if we can't find proper request, we need to return q.end(),
+        // so that no command will be scheduled
+        int scope = int(ctrl->channel->spec->scope[int(T::Command::PRE)]);
+        for (auto& group : groups) {
+            if ((!group.hit) && group.open) {
+                // so the next instruction to be scheduled is PRE, might violate hit
+                // TODO Here it assumes all DRAM standards use PRE to close a row
+                // It's better to make it more general.
                 bool violate_hit = false;
-                if ((!this->ctrl->is_row_hit(itr)) && this->ctrl->is_row_open(itr)) {
-                    // so the next instruction to be scheduled is PRE, might violate hit
-                    auto begin = itr->addr_vec.begin();
-                    // TODO Here it assumes all DRAM standards use PRE to close a row
-                    // It's better to make it more general.
-                    auto end = begin + int(ctrl->channel->spec->scope[int(T::Command::PRE)]) + 1;
-                    vector<int> rowgroup(begin, end); // bank or subarray
-                    for (const auto& hit_req_rowgroup : hit_reqs) {
-                        if (rowgroup == hit_req_rowgroup) {
-                            violate_hit = true;
-                            break;
-                        }  
+                for (auto& hit_group : groups) {
+                    if (hit_group.hit && same_prefix(hit_group.oldest, group.oldest, scope)) {
+                        violate_hit = true;
+                        break;
                     }
                 }
-                if (violate_hit) {
+                if (violate_hit)
                     continue;
-                }
-                // If it comes here, that means it won't violate any hit request
-                if (head == q.end()) {
-                    head = itr;
-                } else {
-                    head = compare[int(Type::FRFCFS)](head, itr);
-                }
             }
-
-            return head;
+            // If it comes here, that means it won't violate any hit request
+            if (!head || (group.ready != head->ready ? group.ready : older(group, *head)))
+                head = &group;
         }
+
+        return head ? head->oldest : q.end();
     }
 
 //Compare functions for each memory schedulers
 private:
     typedef list<Request>::iterator ReqIter;
-    function<ReqIter(ReqIter, ReqIter)> compare[int(Type::MAX)] = {
-        // FCFS
-        [this] (ReqIter req1, ReqIter req2) {
-            if (req1->arrive <= req2->arrive) return req1;
-            return req2;},
-
-        // FRFCFS
-        [this] (ReqIter req1, ReqIter req2) {
-            bool ready1 = this->ctrl->is_ready(req1);
-            bool ready2 = this->ctrl->is_ready(req2);
-
-            if (ready1 ^ ready2) {
-                if (ready1) return req1;
-                return req2;
-            }
 
-            if (req1->arrive <= req2->arrive) return req1;
-            return req2;},
+    // Per-bank index of the queue, rebuilt at each head selection. The first
+    // command, its timing checks and the row state of a request only depend on
+    // its type and its address down to the row, so FR-FCFS evaluates them once
+    // per row of a bank instead of once per request and comparison.
+    struct RowGroup {
+        ReqIter oldest;  // first of the requests with the earliest arrival
+        int pos;         // position of oldest in the queue, to break ties
+        bool ready;      // FRFCFS_Cap: also under the cap of row hits
+        bool hit;
+        bool open;
+    };
+    vector<RowGroup> groups;
+    vector<int> slots;  // open-addressing hash of the groups, -1 if free
 
-        // FRFCFS_CAP
-        [this] (ReqIter req1, ReqIter req2) {
-            bool ready1 = this->ctrl->is_ready(req1);
-            bool ready2 = this->ctrl->is_ready(req2);
+    ReqIter compare_fcfs(ReqIter req1, ReqIter req2)
+    {
+        if (req1->arrive <= req2->arrive) return req1;
+        return req2;
+    }
 
-            ready1 = ready1 && (this->ctrl->rowtable->get_hits(req1->addr_vec) <= this->cap);
-            ready2 = ready2 && (this->ctrl->rowtable->get_hits(req2->addr_vec) <= this->cap);
+    static bool older(const RowGroup& group1, const RowGroup& group2)
+    {
+        if (group1.oldest->arrive != group2.oldest->arrive)
+            return group1.oldest->arrive < group2.oldest->arrive;
+        return group1.pos < group2.pos;
+    }
 
-            if (ready1 ^ ready2) {
-                if (ready1) return req1;
-                return req2;
-            }
+    static bool same_prefix(ReqIter req1, ReqIter req2, int last_level)
+    {
+        for (int lvl = 0; lvl <= last_level; lvl++)
+            if (req1->addr_vec[lvl] != req2->addr_vec[lvl])
+                return false;
+        return true;
+    }
 
-            if (req1->arrive <= req2->arrive) return req1;
-            return req2;},
-        // FRFCFS_PriorHit
-        [this] (ReqIter req1, ReqIter req2) {
-            bool ready1 = this->ctrl->is_ready(req1) && this->ctrl->is_row_hit(req1);
-            bool ready2 = this->ctrl->is_ready(req2) && this->ctrl->is_row_hit(req2);
+    void index_rows(list<Request>& q)
+    {
+        size_t size = 16;
+        while (size < 2 * q.size())
+            size *= 2;
+        slots.assign(size, -1);
+        groups.clear();
+
+        int pos = 0;
+        for (auto itr = q.begin(); itr != q.end(); itr++, pos++) {
+            size_t hash = size_t(itr->type);
+            for (int lvl = 0; lvl <= int(T::Level::Row); lvl++)
+                hash = hash * 31 + size_t(itr->addr_vec[lvl]);
+
+            size_t slot = hash & (size - 1);
+            while (slots[slot] != -1) {
+                RowGroup& group = groups[slots[slot]];
+                if (group.oldest->type == itr->type &&
+                        same_prefix(group.oldest, itr, int(T::Level::Row)))
+                    break;
+                slot = (slot + 1) & (size - 1);
+            }
 
-            if (ready1 ^ ready2) {
-                if (ready1) return req1;
-                return req2;
+            if (slots[slot] != -1) {
+                RowGroup& group = groups[slots[slot]];
+                if (itr->arrive < group.oldest->arrive) {
+                    group.oldest = itr;
+                    group.pos = pos;
+                }
+                continue;
             }
 
-            if (req1->arrive <= req2->arrive) return req1;
-            return req2;}
-    };
+            RowGroup group;
+            group.oldest = itr;
+            group.pos = pos;
+            group.ready = ctrl->is_ready(itr);
+            if (type == Type::FRFCFS_Cap)
+                group.ready = group.ready && (ctrl->rowtable->get_hits(itr->addr_vec) <= cap);
+            group.hit = type == Type::FRFCFS_PriorHit && ctrl->is_row_hit(itr);
+            group.open = type == Type::FRFCFS_PriorHit && ctrl->is_row_open(itr);
+            slots[slot] = groups.size();
+            groups.push_back(group);
+        }
+    }
 };
 
-
 // Row Precharge Policy
 template <typename T>
 class RowPolicy
@@ -221,7 +248,14 @@ public:
 
     enum class Type {
         Closed, ClosedAP, Opened, Timeout, MAX
-    } type = Type::Opened;
+    } type = Type::Opened; // Default row policy, set with the row_policy key of the config
+
+    map<string, Type> name_to_type = {
+        {"Closed", Type::Closed},
+        {"ClosedAP", Type::ClosedAP},
+        {"Opened", Type::Opened},
+        {"Timeout", Type::Timeout},
+    };
 
     int timeout = 50;
 
@@ -450,6 +484,15 @@ void RowTable<LPDDR4_AB>::update(typename LPDDR4_AB::Command cmd, const vector<i
 template <>
 void RowTable<GDDR5_AB>::update(typename GDDR5_AB::Command cmd, const vector<int>& addr_vec, long clk);
 
+template <>
+void RowTable<PCM_AB>::update(typename PCM_AB::Command cmd, const vector<int>& addr_vec, long clk);
+
+template <>
+void RowTable<RRAM_AB>::update(typename RRAM_AB::Command cmd, const vector<int>& addr_vec, long clk);
+
+template <>
+void RowTable<STTRAM_AB>::update(typename STTRAM_AB::Command cmd, const vector<int>& addr_vec, long clk);
+
 template <>
 int RowTable<HBM_AB>::get_hits(const vector<int>& addr_vec, const bool to_opened_row);
 
@@ -465,6 +508,15 @@ int RowTable<LPDDR4_AB>::get_hits(const vector<int>& addr_vec, const bool to_ope
 template <>
 int RowTable<GDDR5_AB>::get_hits(const vector<int>& addr_vec, const bool to_opened_row);
 
+template <>
+int RowTable<PCM_AB>::get_hits(const vector<int>& addr_vec, const bool to_opened_row);
+
+template <>
+int RowTable<RRAM_AB>::get_hits(const vector<int>& addr_vec, const bool to_opened_row);
+
+template <>
+int RowTable<STTRAM_AB>::get_hits(const vector<int>& addr_vec, const bool to_opened_row);
+
 template <>
 int RowTable<HBM_AB>::get_open_row(const vector<int>& addr_vec);
 
@@ -480,6 +532,15 @@ int RowTable<LPDDR4_AB>::get_open_row(const vector<int>& addr_vec);
 template <>
 int RowTable<GDDR5_AB>::get_open_row(const vector<int>& addr_vec);
 
+template <>
+int RowTable<PCM_AB>::get_open_row(const vector<int>& addr_vec);
+
+template <>
+int RowTable<RRAM_AB>::get_open_row(const vector<int>& addr_vec);
+
+template <>
+int RowTable<STTRAM_AB>::get_open_row(const vector<int>& addr_vec);
+
 } /*namespace ramulator*/
 
 #endif /*__SCHEDULER_H*/
@@ -35,13 +35,19 @@
   Stats::StandardDeviation --> StandardDeviationStat
   Stats::AverageDeviation --> AverageDeviationStat
 
-  All of the stats that you create will be named "ramulator.<your name>"
-  automatically, and will be dumped at the end of simulation into the gem5
-  stats file.
+  All of the stats that you create will be named "<prefix>.<your name>"
+  automatically, and will be dumped with the rest of the gem5 stats. The
+  prefix is "ramulator" unless stat_prefix() is set before creating the
+  memory, gem5 sets it to the name of the Ramulator SimObject.
 */
 
 namespace ramulator {
 
+inline std::string& stat_prefix() {
+    static std::string prefix = "ramulator";
+    return prefix;
+}
+
 template<class StatType>
 class StatBase { // wrapper for Stats::DataWrap
   protected:
@@ -69,7 +75,7 @@ class StatBase { // wrapper for Stats::DataWrap
 
     StatBase<StatType> & name(std::string _name) {
       statName = _name;
-      stat.name("ramulator." + _name);
+      stat.name(stat_prefix() + "." + _name);
 
       return self();
     }
@@ -171,7 +171,7 @@ ExtMaster::handleEvent(SST::Event* event)
         cmdO = MemCmd::StoreCondReq;
     }
 
-    auto req = std::make_shared<Request>(ev->getAddr(), ev->getSize(), flags, 0);
+    auto req = makeRequest(ev->getAddr(), ev->getSize(), flags, 0);
     req->setContext(ev->getGroupId());
 
     auto pkt = new Packet(req, cmdO);
@@ -175,7 +175,7 @@ ExtSlave::handleEvent(Event* ev)
 
         // make Req/Pkt for Snoop/no response needed
         // presently no consideration for masterId, packet type, flags...
-        RequestPtr req = std::make_shared<Request>(
+        RequestPtr req = makeRequest(
             event->getAddr(), event->getSize(), 0, 0);
 
         auto pkt = new Packet(req, ::MemCmd::InvalidateReq);
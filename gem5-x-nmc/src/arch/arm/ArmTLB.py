@@ -42,6 +42,7 @@ from m5.params import *
 from m5.proxy import *
 from MemObject import MemObject
 from BaseTLB import BaseTLB
+from ReplacementPolicies import *
 
 # Basic stage 1 translation objects
 class ArmTableWalker(MemObject):
@@ -66,6 +67,9 @@ class ArmTLB(BaseTLB):
     cxx_header = "arch/arm/tlb.hh"
     sys = Param.System(Parent.any, "system object parameter")
     size = Param.Int(64, "TLB size")
+    assoc = Param.Int(0, "TLB associativity, 0 for fully associative")
+    replacement_policy = Param.BaseReplacementPolicy(LRURP(),
+        "Replacement policy")
     walker = Param.ArmTableWalker(ArmTableWalker(), "HW Table walker")
     is_stage2 = Param.Bool(False, "Is this a stage 2 TLB?")
 
@@ -56,7 +56,9 @@
 #include "arch/arm/table_walker.hh"
 #include "arch/arm/utility.hh"
 #include "arch/generic/mmapped_ipr.hh"
+#include "base/bitfield.hh"
 #include "base/inifile.hh"
+#include "base/intmath.hh"
 #include "base/str.hh"
 #include "base/trace.hh"
 #include "cpu/base.hh"
@@ -75,15 +77,25 @@ using namespace ArmISA;
 
 TLB::TLB(const ArmTLBParams *p)
     : BaseTLB(p), table(new TlbEntry[p->size]), size(p->size),
+      assoc(p->assoc ? p->assoc : p->size), numSets(size / assoc),
+      setShift(floorLog2(numSets)),
       isStage2(p->is_stage2), stage2Req(false), _attr(0),
       directToStage2(false), tableWalker(p->walker), stage2Tlb(NULL),
-      stage2Mmu(NULL), test(nullptr), rangeMRU(1),
+      stage2Mmu(NULL), test(nullptr), replEntries(p->size),
+      replacementPolicy(p->replacement_policy), pageSizesInUse(0),
       aarch64(false), aarch64EL(EL0), isPriv(false), isSecure(false),
       isHyp(false), asid(0), vmid(0), dacr(0),
       miscRegValid(false), miscRegContext(0), curTranType(NormalTran)
 {
     const ArmSystem *sys = dynamic_cast<const ArmSystem *>(p->sys);
 
+    fatal_if(size % assoc || !isPowerOf2(numSets),
+             "%s: %d entries do not make a power of two sets of %d ways\n",
+             name(), size, assoc);
+    for (auto &repl_entry : replEntries)
+        repl_entry.replacementData = replacementPolicy->instantiateEntry();
+    pageSizeEntries.fill(0);
+
     tableWalker->setTlb(this);
 
     // Cache system-level properties
@@ -155,26 +167,25 @@ TLB::lookup(Addr va, uint16_t asn, uint8_t vmid, bool hyp, bool secure,
 
     TlbEntry *retval = NULL;
 
-    // Maintaining LRU array
-    int x = 0;
-    while (retval == NULL && x < size) {
-        if ((!ignore_asn && table[x].match(va, asn, vmid, hyp, secure, false,
-             target_el)) ||
-            (ignore_asn && table[x].match(va, vmid, hyp, secure, target_el))) {
-            // We only move the hit entry ahead when the position is higher
-            // than rangeMRU
-            if (x > rangeMRU && !functional) {
-                TlbEntry tmp_entry = table[x];
-                for (int i = x; i > 0; i--)
-                    table[i] = table[i - 1];
-                table[0] = tmp_entry;
-                retval = &table[0];
-            } else {
+    // Probe the set the address maps to for every page size in use, a
+    // fully associative TLB has a single set to search
+    uint64_t page_sizes = pageSizesInUse;
+    while (retval == NULL && page_sizes) {
+        const int n = findLsbSet(page_sizes);
+        page_sizes = numSets > 1 ? page_sizes & (page_sizes - 1) : 0;
+
+        const int first = setIndex(va >> n) * assoc;
+        for (int x = first; x < first + assoc; ++x) {
+            if ((!ignore_asn && table[x].match(va, asn, vmid, hyp, secure,
+                 false, target_el)) ||
+                (ignore_asn && table[x].match(va, vmid, hyp, secure,
+                 target_el))) {
+                if (!functional)
+                    replacementPolicy->touch(replEntries[x].replacementData);
                 retval = &table[x];
+                break;
             }
-            break;
         }
-        ++x;
     }
 
     DPRINTF(TLBVerbose, "Lookup %#x, asn %#x -> %s vmn 0x%x hyp %d secure %d "
@@ -202,23 +213,56 @@ TLB::insert(Addr addr, TlbEntry &entry)
             entry.ap, static_cast<uint8_t>(entry.domain), entry.ns, entry.nstid,
             entry.isHyp);
 
-    if (table[size - 1].valid)
+    place(entry);
+
+    inserts++;
+    ppRefills->notify(1);
+}
+
+TlbEntry *
+TLB::place(const TlbEntry &entry)
+{
+    const int first = setIndex(entry.vpn) * assoc;
+
+    // An invalid way of the set if there is one, as the replacement
+    // policy may pick a valid entry among ways touched on the same tick
+    int victim = first;
+    while (victim < first + assoc && table[victim].valid)
+        ++victim;
+    if (victim == first + assoc) {
+        ReplacementCandidates candidates;
+        for (int x = first; x < first + assoc; ++x)
+            candidates.push_back(&replEntries[x]);
+        victim = replacementPolicy->getVictim(candidates) - &replEntries[0];
+    }
+    TlbEntry *te = &table[victim];
+
+    if (te->valid) {
         DPRINTF(TLB, " - Replacing Valid entry %#x, asn %d vmn %d ppn %#x "
                 "size: %#x ap:%d ns:%d nstid:%d g:%d isHyp:%d el: %d\n",
-                table[size-1].vpn << table[size-1].N, table[size-1].asid,
-                table[size-1].vmid, table[size-1].pfn << table[size-1].N,
-                table[size-1].size, table[size-1].ap, table[size-1].ns,
-                table[size-1].nstid, table[size-1].global, table[size-1].isHyp,
-                table[size-1].el);
-
-    //inserting to MRU position and evicting the LRU one
+                te->vpn << te->N, te->asid, te->vmid, te->pfn << te->N,
+                te->size, te->ap, te->ns, te->nstid, te->global, te->isHyp,
+                te->el);
+        invalidateEntry(te);
+    }
 
-    for (int i = size - 1; i > 0; --i)
-        table[i] = table[i-1];
-    table[0] = entry;
+    *te = entry;
+    if (te->valid) {
+        if (pageSizeEntries[te->N]++ == 0)
+            pageSizesInUse |= ULL(1) << te->N;
+        replacementPolicy->reset(replEntries[victim].replacementData);
+    }
+    return te;
+}
 
-    inserts++;
-    ppRefills->notify(1);
+void
+TLB::invalidateEntry(TlbEntry *te)
+{
+    assert(te->valid);
+    te->valid = false;
+    if (--pageSizeEntries[te->N] == 0)
+        pageSizesInUse &= ~(ULL(1) << te->N);
+    replacementPolicy->invalidate(replEntries[te - table].replacementData);
 }
 
 void
@@ -249,7 +293,7 @@ TLB::flushAllSecurity(bool secure_lookup, uint8_t target_el, bool ignore_el)
             checkELMatch(target_el, te->el, ignore_el)) {
 
             DPRINTF(TLB, " -  %s\n", te->print());
-            te->valid = false;
+            invalidateEntry(te);
             flushedEntries++;
         }
         ++x;
@@ -278,7 +322,7 @@ TLB::flushAllNs(bool hyp, uint8_t target_el, bool ignore_el)
 
             DPRINTF(TLB, " -  %s\n", te->print());
             flushedEntries++;
-            te->valid = false;
+            invalidateEntry(te);
         }
         ++x;
     }
@@ -316,8 +360,8 @@ TLB::flushAsid(uint64_t asn, bool secure_lookup, uint8_t target_el)
             (te->vmid == vmid || secure_lookup) &&
             checkELMatch(target_el, te->el, false)) {
 
-            te->valid = false;
             DPRINTF(TLB, " -  %s\n", te->print());
+            invalidateEntry(te);
             flushedEntries++;
         }
         ++x;
@@ -346,7 +390,7 @@ TLB::_flushMva(Addr mva, uint64_t asn, bool secure_lookup, bool hyp,
     while (te != NULL) {
         if (secure_lookup == !te->nstid) {
             DPRINTF(TLB, " -  %s\n", te->print());
-            te->valid = false;
+            invalidateEntry(te);
             flushedEntries++;
         }
         te = lookup(mva, asn, vmid, hyp, secure_lookup, false, ignore_asn,
@@ -394,6 +438,14 @@ TLB::takeOverFrom(BaseTLB *_otlb)
         directToStage2 = otlb->directToStage2;
         stage2Req = otlb->stage2Req;
 
+        // Keep the translations warm across CPU switches, e.g. while
+        // sampling. The entries are placed in their sets again, the
+        // geometries of the TLBs may differ.
+        for (int i = 0; i < otlb->size; i++) {
+            if (otlb->table[i].valid)
+                place(otlb->table[i]);
+        }
+
         /* Sync the stage2 MMU if they exist in both
          * the old CPU and the new
          */
@@ -432,10 +484,21 @@ TLB::unserialize(CheckpointIn &cp)
     UNSERIALIZE_SCALAR(directToStage2);
     UNSERIALIZE_SCALAR(stage2Req);
 
+    for (int i = 0; i < size; i++) {
+        if (table[i].valid)
+            invalidateEntry(&table[i]);
+    }
+
+    // The entries are placed in their sets again, so the checkpoint does
+    // not depend on the geometry of the TLB that took it
     int num_entries;
     UNSERIALIZE_SCALAR(num_entries);
-    for (int i = 0; i < min(size, num_entries); i++)
-        table[i].unserializeSection(cp, csprintf("TlbEntry%d", i));
+    for (int i = 0; i < min(size, num_entries); i++) {
+        TlbEntry entry;
+        entry.unserializeSection(cp, csprintf("TlbEntry%d", i));
+        if (entry.valid)
+            place(entry);
+    }
 }
 
 void
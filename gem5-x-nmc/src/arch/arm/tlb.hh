@@ -43,6 +43,8 @@
 #ifndef __ARCH_ARM_TLB_HH__
 #define __ARCH_ARM_TLB_HH__
 
+#include <array>
+#include <vector>
 
 #include "arch/arm/isa_traits.hh"
 #include "arch/arm/pagetable.hh"
@@ -50,6 +52,7 @@
 #include "arch/arm/vtophys.hh"
 #include "arch/generic/tlb.hh"
 #include "base/statistics.hh"
+#include "mem/cache/replacement_policies/base.hh"
 #include "mem/request.hh"
 #include "params/ArmTLB.hh"
 #include "sim/probe/pmu.hh"
@@ -148,8 +151,11 @@ class TLB : public BaseTLB
     static ExceptionLevel tranTypeEL(CPSR cpsr, ArmTranslationType type);
 
   protected:
-    TlbEntry* table;     // the Page Table
+    TlbEntry* table;     // the Page Table, set after set
     int size;            // TLB Size
+    int assoc;           // Entries per set, size when fully associative
+    int numSets;         // Number of sets, a power of two
+    int setShift;        // log2 of numSets
     bool isStage2;       // Indicates this TLB is part of the second stage MMU
     bool stage2Req;      // Indicates whether a stage 2 lookup is also required
     uint64_t _attr;      // Memory attributes for last accessed TLB entry
@@ -190,7 +196,30 @@ class TLB : public BaseTLB
     /** PMU probe for TLB refills */
     ProbePoints::PMUUPtr ppRefills;
 
-    int rangeMRU; //On lookup, only move entries ahead when outside rangeMRU
+    /** Replacement data of the entries, replEntries[i] is for table[i] */
+    std::vector<ReplaceableEntry> replEntries;
+    BaseReplacementPolicy *replacementPolicy;
+
+    /**
+     * Valid entries of each page size (log2). An entry sits in the set
+     * given by its vpn, so a lookup only probes the sets of the page
+     * sizes in use.
+     */
+    std::array<int, 64> pageSizeEntries;
+    uint64_t pageSizesInUse;
+
+    /** Set of a vpn, its upper bits are folded in so that large
+     * power-of-two strides do not fall in a single set */
+    int
+    setIndex(Addr vpn) const
+    {
+        return (vpn ^ (vpn >> setShift)) & (numSets - 1);
+    }
+
+    /** Place an entry in its set, evicting the victim of the policy */
+    TlbEntry *place(const TlbEntry &entry);
+
+    void invalidateEntry(TlbEntry *te);
 
   public:
     TLB(const ArmTLBParams *p);
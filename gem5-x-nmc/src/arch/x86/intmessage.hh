@@ -79,7 +79,7 @@ namespace X86ISA
     static inline PacketPtr
     prepIntRequest(const uint8_t id, Addr offset, Addr size)
     {
-        RequestPtr req = std::make_shared<Request>(
+        RequestPtr req = makeRequest(
             x86InterruptAddress(id, offset),
             size, Request::UNCACHEABLE,
             Request::intMasterId);
@@ -0,0 +1,215 @@
+ /*
+ * Copyright EPFL 2024
+ * Rafael Medina Morillas
+ *
+ */
+
+/**
+ * @file
+ * Pools of fixed-size blocks for the objects created at every memory
+ * access: packets, requests and the data of the packets.
+ */
+
+#ifndef __BASE_SLAB_POOL_HH__
+#define __BASE_SLAB_POOL_HH__
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+/**
+ * Pool of blocks of Size bytes. Each thread, that is each event queue,
+ * has its own list of free blocks, so no lock is taken on allocation. A
+ * block goes back to the pool of the thread that allocated it: the slabs
+ * are aligned to their size and start with their owner, and a block
+ * freed by another thread is pushed on the remote free list of the
+ * owner, a lock-free stack that the owner takes whole when its own list
+ * runs out. The slabs and the pools are never given back to the system,
+ * as blocks can be freed after their thread is done.
+ */
+template <size_t Size>
+class SlabPool
+{
+  private:
+    struct Block
+    {
+        Block *next;
+    };
+
+    struct Pool
+    {
+        Block *freeList;
+        /** Blocks freed by other threads, pushed by any thread */
+        std::atomic<Block *> remoteFree;
+
+        Pool() : freeList(nullptr), remoteFree(nullptr) {}
+    };
+
+    struct Slab
+    {
+        Pool *owner;
+    };
+
+    static const size_t Align = alignof(std::max_align_t);
+    static const size_t BlockSize =
+        ((Size > sizeof(Block) ? Size : sizeof(Block)) + Align - 1) &
+        ~(Align - 1);
+    static const size_t SlabBytes = 64 * 1024;
+    static const size_t HeaderBytes = (sizeof(Slab) + Align - 1) & ~(Align - 1);
+    static const size_t BlocksPerSlab = (SlabBytes - HeaderBytes) / BlockSize;
+
+    static_assert(BlocksPerSlab > 0, "Blocks too large for the slabs");
+
+    static __thread Pool *localPool;
+
+    static Pool *
+    pool()
+    {
+        if (!localPool)
+            localPool = new Pool;
+        return localPool;
+    }
+
+    static void
+    refill(Pool *p)
+    {
+        p->freeList = p->remoteFree.exchange(nullptr,
+                                             std::memory_order_acquire);
+        if (p->freeList)
+            return;
+
+        void *mem;
+        if (posix_memalign(&mem, SlabBytes, SlabBytes))
+            throw std::bad_alloc();
+        Slab *slab = static_cast<Slab *>(mem);
+        slab->owner = p;
+        char *blocks = static_cast<char *>(mem) + HeaderBytes;
+        for (size_t i = 0; i < BlocksPerSlab; ++i) {
+            Block *block = reinterpret_cast<Block *>(blocks + i * BlockSize);
+            block->next = p->freeList;
+            p->freeList = block;
+        }
+    }
+
+  public:
+    static void *
+    allocate()
+    {
+        Pool *p = pool();
+        if (!p->freeList)
+            refill(p);
+        Block *block = p->freeList;
+        p->freeList = block->next;
+        return block;
+    }
+
+    static void
+    release(void *ptr)
+    {
+        Block *block = static_cast<Block *>(ptr);
+        Slab *slab = reinterpret_cast<Slab *>(
+            reinterpret_cast<uintptr_t>(ptr) & ~uintptr_t(SlabBytes - 1));
+        Pool *owner = slab->owner;
+
+        if (owner == localPool) {
+            block->next = owner->freeList;
+            owner->freeList = block;
+            return;
+        }
+
+        // the owner only takes the whole stack, so there is no ABA
+        block->next = owner->remoteFree.load(std::memory_order_relaxed);
+        while (!owner->remoteFree.compare_exchange_weak(
+                   block->next, block, std::memory_order_release,
+                   std::memory_order_relaxed)) {
+        }
+    }
+};
+
+template <size_t Size>
+__thread typename SlabPool<Size>::Pool *SlabPool<Size>::localPool = nullptr;
+
+/**
+ * Allocator of single objects from the pool of their size, for
+ * std::allocate_shared. Arrays come from the global operator new.
+ */
+template <typename T>
+struct SlabAllocator
+{
+    typedef T value_type;
+
+    SlabAllocator() {}
+    template <typename U> SlabAllocator(const SlabAllocator<U> &) {}
+
+    T *
+    allocate(size_t n)
+    {
+        if (n != 1)
+            return static_cast<T *>(::operator new(n * sizeof(T)));
+        return static_cast<T *>(SlabPool<sizeof(T)>::allocate());
+    }
+
+    void
+    deallocate(T *p, size_t n)
+    {
+        if (n != 1)
+            ::operator delete(p);
+        else
+            SlabPool<sizeof(T)>::release(p);
+    }
+};
+
+template <typename T, typename U>
+inline bool
+operator==(const SlabAllocator<T> &, const SlabAllocator<U> &)
+{
+    return true;
+}
+
+template <typename T, typename U>
+inline bool
+operator!=(const SlabAllocator<T> &, const SlabAllocator<U> &)
+{
+    return false;
+}
+
+/** Largest buffer served by slabBufferAllocate(). */
+static const size_t SlabBufferMax = 256;
+
+/**
+ * Buffer of up to SlabBufferMax bytes, from the pool of the next power
+ * of two. It must be released with the same size.
+ */
+inline void *
+slabBufferAllocate(size_t size)
+{
+    if (size <= 16)
+        return SlabPool<16>::allocate();
+    else if (size <= 32)
+        return SlabPool<32>::allocate();
+    else if (size <= 64)
+        return SlabPool<64>::allocate();
+    else if (size <= 128)
+        return SlabPool<128>::allocate();
+    else
+        return SlabPool<256>::allocate();
+}
+
+inline void
+slabBufferRelease(void *p, size_t size)
+{
+    if (size <= 16)
+        SlabPool<16>::release(p);
+    else if (size <= 32)
+        SlabPool<32>::release(p);
+    else if (size <= 64)
+        SlabPool<64>::release(p);
+    else if (size <= 128)
+        SlabPool<128>::release(p);
+    else
+        SlabPool<256>::release(p);
+}
+
+#endif // __BASE_SLAB_POOL_HH__
@@ -0,0 +1,334 @@
+ /*
+ * Copyright EPFL 2024
+ * Rafael Medina Morillas
+ *
+ */
+
+#include "base/stats/binary.hh"
+
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+
+#include "base/logging.hh"
+#include "base/output.hh"
+#include "base/stats/info.hh"
+#include "sim/core.hh"
+
+using namespace std;
+
+namespace Stats {
+
+namespace {
+
+const char binaryMagic[8] = "gem5bst";
+const uint32_t binaryVersion = 1;
+
+} // anonymous namespace
+
+Binary::Binary(std::ostream &_stream)
+    : stream(&_stream), naming(false), layout(0), lastLayout(0),
+      hasSchema(false)
+{
+    if (!valid())
+        fatal("Unable to open output stream for writing\n");
+
+    write(binaryMagic, sizeof(binaryMagic));
+    write(binaryVersion);
+}
+
+void
+Binary::write(const void *data, size_t size)
+{
+    stream->write(static_cast<const char *>(data), size);
+}
+
+bool
+Binary::valid() const
+{
+    return stream != NULL && stream->good();
+}
+
+void
+Binary::begin()
+{
+    values.clear();
+    visited.clear();
+    layout = 0;
+}
+
+void
+Binary::end()
+{
+    if (!hasSchema || layout != lastLayout) {
+        // Visit the stats again, naming their columns this time
+        vector<const Info *> stats;
+        stats.swap(visited);
+        values.clear();
+        names.clear();
+        layout = 0;
+
+        naming = true;
+        for (auto info : stats)
+            const_cast<Info *>(info)->visit(*this);
+        naming = false;
+
+        writeSchema();
+        lastValues.clear();
+        lastLayout = layout;
+        hasSchema = true;
+    }
+
+    writeDump();
+    values.swap(lastValues);
+    stream->flush();
+}
+
+bool
+Binary::noOutput(const Info &info)
+{
+    // The prerequisites are ignored, for the columns not to change
+    // from one dump to the next
+    return !info.flags.isSet(display);
+}
+
+void
+Binary::record(const Info &info)
+{
+    visited.push_back(&info);
+    layout = layout * 31 + values.size();
+}
+
+void
+Binary::writeSchema()
+{
+    write('S');
+    write((uint32_t)names.size());
+    for (const auto &name : names) {
+        uint16_t length = min(name.size(), (size_t)UINT16_MAX);
+        write(length);
+        write(name.data(), length);
+    }
+}
+
+void
+Binary::writeDump()
+{
+    size_t size = values.size();
+    bool all = lastValues.size() != size;
+
+    // Compare the bits, so that NaNs are unchanged
+    changed.assign((size + 7) / 8, 0);
+    for (size_t i = 0; i < size; ++i) {
+        if (all || memcmp(&values[i], &lastValues[i], sizeof(Result)))
+            changed[i / 8] |= 1 << (i % 8);
+    }
+
+    write('D');
+    write((uint64_t)curTick());
+    write(changed.data(), changed.size());
+    for (size_t i = 0; i < size; ++i) {
+        if (changed[i / 8] & (1 << (i % 8)))
+            write(values[i]);
+    }
+}
+
+void
+Binary::visit(const ScalarInfo &info)
+{
+    if (noOutput(info))
+        return;
+
+    values.push_back(info.result());
+    if (naming)
+        names.push_back(info.name);
+    record(info);
+}
+
+void
+Binary::visitVector(const string &name, const vector<string> &subnames,
+                    const VResult &vec, bool with_total)
+{
+    string base = naming ? name + Info::separatorString : string();
+    bool havesub = !subnames.empty();
+    Result total = 0.0;
+
+    for (off_type i = 0; i < vec.size(); ++i) {
+        total += vec[i];
+        if (havesub && (i >= subnames.size() || subnames[i].empty()))
+            continue;
+
+        values.push_back(vec[i]);
+        if (naming) {
+            names.push_back(vec.size() == 1 && !havesub ? name :
+                base + (havesub ? subnames[i] : to_string(i)));
+        }
+    }
+
+    if (with_total) {
+        values.push_back(total);
+        if (naming)
+            names.push_back(base + "total");
+    }
+}
+
+void
+Binary::visit(const VectorInfo &info)
+{
+    if (noOutput(info))
+        return;
+
+    visitVector(info.name, info.subnames, info.result(),
+                info.flags.isSet(::Stats::total));
+    record(info);
+}
+
+void
+Binary::visit(const Vector2dInfo &info)
+{
+    if (noOutput(info))
+        return;
+
+    bool havesub = false;
+    for (off_type i = 0; i < info.subnames.size(); ++i)
+        havesub = havesub || !info.subnames[i].empty();
+
+    vector<string> y_subnames(info.y);
+    for (off_type j = 0; j < info.y; ++j) {
+        y_subnames[j] = j < info.y_subnames.size() &&
+            !info.y_subnames[j].empty() ? info.y_subnames[j] : to_string(j);
+    }
+
+    VResult yvec(info.y);
+    for (off_type i = 0; i < info.x; ++i) {
+        if (havesub && (i >= info.subnames.size() || info.subnames[i].empty()))
+            continue;
+
+        for (off_type j = 0; j < info.y; ++j)
+            yvec[j] = info.cvec[i * info.y + j];
+
+        visitVector(naming ? info.name + "_" +
+                    (havesub ? info.subnames[i] : to_string(i)) : string(),
+                    y_subnames, yvec, info.flags.isSet(::Stats::total));
+    }
+
+    if (info.flags.isSet(::Stats::total) && info.x > 1) {
+        values.push_back(info.total());
+        if (naming)
+            names.push_back(info.name + Info::separatorString + "total");
+    }
+    record(info);
+}
+
+void
+Binary::visitDist(const string &name, const DistData &data)
+{
+    string base = naming ? name + Info::separatorString : string();
+    auto column = [&](const char *suffix, Result value) {
+        values.push_back(value);
+        if (naming)
+            names.push_back(base + suffix);
+    };
+
+    column("samples", data.samples);
+    column("mean", data.samples ? data.sum / data.samples : NAN);
+    if (data.type == Hist)
+        column("gmean", data.samples ? exp(data.logs / data.samples) : NAN);
+    column("stdev", data.samples ?
+           sqrt((data.samples * data.squares - data.sum * data.sum) /
+                (data.samples * (data.samples - 1.0))) : NAN);
+
+    if (data.type == Deviation)
+        return;
+
+    column("bucket_size", data.bucket_size);
+    column("min_bucket", data.min);
+
+    Result total = 0.0;
+    if (data.type == Dist) {
+        column("underflows", data.underflow);
+        total += data.underflow;
+    }
+    for (off_type i = 0; i < data.cvec.size(); ++i) {
+        values.push_back(data.cvec[i]);
+        if (naming)
+            names.push_back(base + "bucket" + to_string(i));
+        total += data.cvec[i];
+    }
+    if (data.type == Dist) {
+        column("overflows", data.overflow);
+        column("min_value", data.min_val);
+        column("max_value", data.max_val);
+        total += data.overflow;
+    }
+    column("total", total);
+}
+
+void
+Binary::visit(const DistInfo &info)
+{
+    if (noOutput(info))
+        return;
+
+    visitDist(info.name, info.data);
+    record(info);
+}
+
+void
+Binary::visit(const VectorDistInfo &info)
+{
+    if (noOutput(info))
+        return;
+
+    for (off_type i = 0; i < info.size(); ++i) {
+        visitDist(naming ? info.name + "_" + (info.subnames[i].empty() ?
+                  to_string(i) : info.subnames[i]) : string(), info.data[i]);
+    }
+    record(info);
+}
+
+void
+Binary::visit(const FormulaInfo &info)
+{
+    visit((const VectorInfo &)info);
+}
+
+void
+Binary::visit(const SparseHistInfo &info)
+{
+    if (noOutput(info))
+        return;
+
+    string base = naming ? info.name + Info::separatorString : string();
+    values.push_back(info.data.samples);
+    if (naming)
+        names.push_back(base + "samples");
+
+    // The keys change the columns
+    for (const auto &bucket : info.data.cmap) {
+        values.push_back(bucket.second);
+        if (naming) {
+            ostringstream key;
+            key << bucket.first;
+            names.push_back(base + key.str());
+        }
+        layout = layout * 31 + bucket.first;
+    }
+    record(info);
+}
+
+Output *
+initBinary(const string &filename)
+{
+    static Binary *binary = NULL;
+
+    if (!binary) {
+        OutputStream *os = simout.findOrCreate(filename, true);
+        binary = new Binary(*os->stream());
+    }
+
+    return binary;
+}
+
+} // namespace Stats
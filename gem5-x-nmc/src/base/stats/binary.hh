@@ -0,0 +1,118 @@
+ /*
+ * Copyright EPFL 2024
+ * Rafael Medina Morillas
+ *
+ */
+
+/**
+ * @file
+ * Binary statistics output, for simulations that dump the statistics
+ * often.
+ *
+ * The file starts with the magic "gem5bst", a null byte and the
+ * version (uint32_t), followed by records starting with their type
+ * (uint8_t), all in the byte order of the host:
+ *
+ * - 'S' schema: number of columns (uint32_t), then for each column the
+ *   length (uint16_t) and the characters of its name. It is written
+ *   before the first dump, and again when the columns change.
+ * - 'D' dump: tick (uint64_t), a bitmap with a bit per column, set for
+ *   the columns that changed since the previous dump, and the values
+ *   (double) of these columns. The first dump after a schema has all
+ *   the bits set.
+ *
+ * Each value of the text output is a column, named as in the text
+ * output. The buckets of the distributions are named by their index,
+ * with the bucket_size and min_bucket columns to find their range, so
+ * the columns stay the same when histograms grow. Contrary to the text
+ * output, zero values and stats whose prerequisite is zero are written.
+ *
+ * util/binary_stats.py reads these files.
+ */
+
+#ifndef __BASE_STATS_BINARY_HH__
+#define __BASE_STATS_BINARY_HH__
+
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include "base/stats/output.hh"
+#include "base/stats/types.hh"
+
+namespace Stats {
+
+class Info;
+struct DistData;
+
+class Binary : public Output
+{
+  protected:
+    std::ostream *stream;
+
+    /** Whether the names of the columns are built by the visits. */
+    bool naming;
+    std::vector<std::string> names;
+
+    /** Values of the current and of the previous dump. */
+    std::vector<Result> values;
+    std::vector<Result> lastValues;
+
+    /** Stats visited by the current dump, to name their columns. */
+    std::vector<const Info *> visited;
+
+    /**
+     * Signature of the columns, from the number of columns of each stat
+     * and the keys of the sparse histograms.
+     */
+    uint64_t layout;
+    uint64_t lastLayout;
+    bool hasSchema;
+
+    /** Bitmap of the changed columns, kept to avoid an allocation. */
+    std::vector<uint8_t> changed;
+
+    bool noOutput(const Info &info);
+    void record(const Info &info);
+    void writeSchema();
+    void writeDump();
+
+    template <typename T>
+    void
+    write(const T &data)
+    {
+        write(&data, sizeof(data));
+    }
+    void write(const void *data, size_t size);
+
+  public:
+    Binary(std::ostream &stream);
+
+    // Implement Visit
+    void visit(const ScalarInfo &info) override;
+    void visit(const VectorInfo &info) override;
+    void visit(const DistInfo &info) override;
+    void visit(const VectorDistInfo &info) override;
+    void visit(const Vector2dInfo &info) override;
+    void visit(const FormulaInfo &info) override;
+    void visit(const SparseHistInfo &info) override;
+
+    // Implement Output
+    bool valid() const override;
+    void begin() override;
+    void end() override;
+
+  protected:
+    /** The names are only used, and built, when naming the columns. */
+    void visitDist(const std::string &name, const DistData &data);
+    void visitVector(const std::string &name,
+                     const std::vector<std::string> &subnames,
+                     const VResult &vec, bool with_total);
+};
+
+Output *initBinary(const std::string &filename);
+
+} // namespace Stats
+
+#endif // __BASE_STATS_BINARY_HH__
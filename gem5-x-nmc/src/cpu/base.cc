@@ -318,7 +318,7 @@ BaseCPU::mwaitAtomic(ThreadID tid, ThreadContext *tc, BaseTLB *dtb)
     assert(tid < numThreads);
     AddressMonitor &monitor = addressMonitor[tid];
 
-    RequestPtr req = std::make_shared<Request>();
+    RequestPtr req = makeRequest();
 
     Addr addr = monitor.vAddr;
     int block_size = cacheLineSize();
@@ -576,10 +576,6 @@ BaseCPU::switchOut()
     if (profileEvent && profileEvent->scheduled())
         deschedule(profileEvent);
 
-    // Flush all TLBs in the CPU to avoid having stale translations if
-    // it gets switched in later.
-    flushTLBs();
-
     // Go to the power gating state
     ClockedObject::pwrState(Enums::PwrState::OFF);
 }
@@ -601,6 +597,10 @@ BaseCPU::takeOverFrom(BaseCPU *oldCPU)
 
     _switchedOut = false;
 
+    // Flush the translations left from the last time this CPU was
+    // switched in, the TLBs may take over the ones of the old CPU below.
+    flushTLBs();
+
     ThreadID size = threadContexts.size();
     for (ThreadID i = 0; i < size; ++i) {
         ThreadContext *newTC = threadContexts[i];
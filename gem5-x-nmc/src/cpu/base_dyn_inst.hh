@@ -903,7 +903,7 @@ BaseDynInst<Impl>::initiateMemRead(Addr addr, unsigned size,
         sreqLow = savedSreqLow;
         sreqHigh = savedSreqHigh;
     } else {
-        req = std::make_shared<Request>(
+        req = makeRequest(
             asid, addr, size, flags, masterId(),
             this->pc.instAddr(), thread->contextId());
 
@@ -923,7 +923,7 @@ BaseDynInst<Impl>::initiateMemRead(Addr addr, unsigned size,
             instFlags[EffAddrValid] = true;
 
             if (cpu->checker) {
-                reqToVerify = std::make_shared<Request>(*req);
+                reqToVerify = makeRequest(*req);
             }
             fault = cpu->read(req, sreqLow, sreqHigh, lqIdx);
         } else {
@@ -957,7 +957,7 @@ BaseDynInst<Impl>::writeMem(uint8_t *data, unsigned size, Addr addr,
         sreqLow = savedSreqLow;
         sreqHigh = savedSreqHigh;
     } else {
-        req = std::make_shared<Request>(
+        req = makeRequest(
             asid, addr, size, flags, masterId(),
             this->pc.instAddr(), thread->contextId());
 
@@ -976,7 +976,7 @@ BaseDynInst<Impl>::writeMem(uint8_t *data, unsigned size, Addr addr,
         instFlags[EffAddrValid] = true;
 
         if (cpu->checker) {
-            reqToVerify = std::make_shared<Request>(*req);
+            reqToVerify = makeRequest(*req);
         }
         fault = cpu->write(req, sreqLow, sreqHigh, data, sqIdx);
     }
@@ -145,7 +145,7 @@ FetchUnit::initiateFetch(Wavefront *wavefront)
     }
 
     // set up virtual request
-    RequestPtr req = std::make_shared<Request>(
+    RequestPtr req = makeRequest(
         0, vaddr, size, Request::INST_FETCH,
         computeUnit->masterId(), 0, 0, nullptr);
 
@@ -339,7 +339,7 @@ Shader::AccessMem(uint64_t address, void *ptr, uint32_t size, int cu_id,
     for (ChunkGenerator gen(address, size, cuList.at(cu_id)->cacheLineSize());
          !gen.done(); gen.next()) {
 
-        RequestPtr req = std::make_shared<Request>(
+        RequestPtr req = makeRequest(
             0, gen.addr(), gen.size(), 0,
             cuList[0]->masterId(), 0, 0, nullptr);
 
@@ -0,0 +1,23 @@
+#  /*
+#  * Copyright EPFL 2024
+#  * Rafael Medina Morillas
+#  *
+#  */
+
+from m5.params import *
+from m5.proxy import *
+from MemObject import MemObject
+
+# Connects two parts of the memory system simulated on different event
+# queues. The slave side is on the event queue of the bridge.
+class EventQueueBridge(MemObject):
+    type = 'EventQueueBridge'
+    cxx_header = "mem/eventq_bridge.hh"
+
+    slave = SlavePort("Slave port, on the event queue of the bridge")
+    master = MasterPort("Master port, on the event queue master_eventq_index")
+
+    master_eventq_index = Param.UInt32(Parent.eventq_index,
+        "Event queue of the master side")
+    delay = Param.Latency('0t', "Latency of the crossing, raised to the "
+        "simulation quantum between different event queues")
@@ -0,0 +1,19 @@
+#  /*
+#  * Copyright EPFL 2024
+#  * Rafael Medina Morillas
+#  *
+#  */
+
+from m5.params import *
+from m5.proxy import *
+from MemObject import MemObject
+
+# Replays the requests recorded at a Ramulator memory with trace_file,
+# see configs/example/nmc_trace_replay.py
+class NMCTracePlayer(MemObject):
+    type = 'NMCTracePlayer'
+    cxx_header = "mem/nmc_trace_player.hh"
+
+    port = MasterPort("Port to the memory to replay the trace against")
+    trace_file = Param.String("NMC trace to replay")
+    system = Param.System(Parent.any, "System the player belongs to")
@@ -6,9 +6,27 @@
 #  */
 
 from m5.SimObject import SimObject
+from m5.params import *
 # A wrapper for Near Memory Computing Cores
 class NMCcores(SimObject):
     type = 'NMCcores'
     cxx_header = "mem/nmccores.hh"
     cxx_class = "NMCcores" 
 
+    binary = Param.String("/gem5-X-NMC/gem5-x-nmc/ext/NMCcores/nmc-cores",
+        "SystemC model of the NMC cores (ANEMOS build) run in a child process")
+    exit_on_mode_change = Param.Bool(False, "Exit the simulation loop when "
+        "the first channel enters NMC mode and when the last one leaves it, "
+        "e.g. to simulate the NMC regions in detail while sampling")
+
+    # Energy per operation of the NMC cores (pJ), e.g. from the synthesis of
+    # the cores for the target technology. The activity counts are reported
+    # as stats regardless of these values.
+    mult_energy = Param.Float(0.0, "Energy of a multiplication in one SIMD lane (pJ)")
+    add_energy = Param.Float(0.0, "Energy of an addition in one SIMD lane (pJ)")
+    grf_read_energy = Param.Float(0.0, "Energy of a GRF register read (pJ)")
+    grf_write_energy = Param.Float(0.0, "Energy of a GRF register write (pJ)")
+    srf_read_energy = Param.Float(0.0, "Energy of a SRF register read (pJ)")
+    srf_write_energy = Param.Float(0.0, "Energy of a SRF register write (pJ)")
+    instr_energy = Param.Float(0.0, "Energy of fetching and decoding a CRF instruction (pJ)")
+    crf_write_energy = Param.Float(0.0, "Energy of a CRF write from the host (pJ)")
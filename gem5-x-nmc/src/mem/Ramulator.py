@@ -10,10 +10,24 @@ class Ramulator(AbstractMemory):
 
     # A single port for now
     port = SlavePort("Slave port")
-    #master = MasterPort("Master port")
+    # Optional, connected to the system crossbar to invalidate the cached
+    # copies of the lines written by the NMC cores
+    master = MasterPort("Master port")
 
     # NMC Memory Object #TODO better comment?
     nmc = Param.NMCcores( NMCcores(), "NMCcores")
 
     config_file = Param.String("", "configuration file")
     num_cpus = Param.Unsigned(1, "Number of cpu")
+    host_profile = Param.Bool(False, "Report the host time spent ticking Ramulator")
+    atomic_latency_model = Param.Bool(True, "Derive the latency of atomic "
+        "accesses from the open rows and timings of the DRAM instead of a "
+        "fixed 50ns")
+    write_combining = Param.Bool(False, "Combine the host stores to a GRF "
+        "line, and in host mode to a burst of the banks, into a single write "
+        "to Ramulator and NMCcores")
+    write_combining_timeout = Param.Latency('100ns', "Time a partial line "
+        "waits for more stores before it is written")
+    trace_file = Param.String("", "Record the timing requests and their "
+        "dependencies on the responses to this file, in the output directory "
+        "if relative, to replay them with an NMCTracePlayer")
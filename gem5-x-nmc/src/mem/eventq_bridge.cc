@@ -0,0 +1,229 @@
+ /*
+ * Copyright EPFL 2024
+ * Rafael Medina Morillas
+ *
+ */
+
+/**
+ * @file
+ * Definition of a bridge between two event queues.
+ */
+
+#include "mem/eventq_bridge.hh"
+
+#include <algorithm>
+
+#include "base/trace.hh"
+#include "debug/EventQueueBridge.hh"
+
+EventQueueBridge::EventQueueBridge(const EventQueueBridgeParams *p)
+    : MemObject(p),
+      slavePort(p->name + ".slave", *this),
+      masterPort(p->name + ".master", *this),
+      slaveQueue(eventQueue()),
+      masterQueue(getEventQueue(p->master_eventq_index)),
+      delay(p->delay)
+{
+}
+
+void
+EventQueueBridge::init()
+{
+    if (!slavePort.isConnected() || !masterPort.isConnected())
+        fatal("Event queue bridge %s is not connected on both sides.\n",
+              name());
+
+    // Events scheduled on another queue must be at least one quantum
+    // away, not to be merged in the past at the next barrier
+    if (slaveQueue != masterQueue)
+        delay = std::max(delay, simQuantum);
+
+    slavePort.sendRangeChange();
+}
+
+BaseMasterPort&
+EventQueueBridge::getMasterPort(const std::string& if_name, PortID idx)
+{
+    if (if_name == "master")
+        return masterPort;
+    else
+        return MemObject::getMasterPort(if_name, idx);
+}
+
+BaseSlavePort&
+EventQueueBridge::getSlavePort(const std::string& if_name, PortID idx)
+{
+    if (if_name == "slave")
+        return slavePort;
+    else
+        return MemObject::getSlavePort(if_name, idx);
+}
+
+DrainState
+EventQueueBridge::drain()
+{
+    std::lock_guard<std::mutex> lock(inFlightLock);
+    return inFlight.empty() ? DrainState::Drained : DrainState::Draining;
+}
+
+void
+EventQueueBridge::cross(PacketPtr pkt, EventQueue *to)
+{
+    DPRINTF(EventQueueBridge, "%s crossing to %s at %d\n", pkt->print(),
+            to->name(), curTick() + delay);
+
+    {
+        std::lock_guard<std::mutex> lock(inFlightLock);
+        inFlight.push_back(pkt);
+    }
+
+    // Scheduled from the other thread, the event goes to the
+    // asynchronous queue of the destination until the next barrier
+    to->schedule(new CrossingEvent(*this, pkt), curTick() + delay);
+}
+
+void
+EventQueueBridge::deliver(PacketPtr pkt)
+{
+    if (pkt->isRequest()) {
+        if (!reqRetryList.empty() || !masterPort.sendTimingReq(pkt)) {
+            reqRetryList.push_back(pkt);
+            return;
+        }
+    } else {
+        if (!respRetryList.empty() || !slavePort.sendTimingResp(pkt)) {
+            respRetryList.push_back(pkt);
+            return;
+        }
+    }
+    done(pkt);
+}
+
+void
+EventQueueBridge::retryReqs()
+{
+    while (!reqRetryList.empty() &&
+           masterPort.sendTimingReq(reqRetryList.front())) {
+        done(reqRetryList.front());
+        reqRetryList.pop_front();
+    }
+}
+
+void
+EventQueueBridge::retryResps()
+{
+    while (!respRetryList.empty() &&
+           slavePort.sendTimingResp(respRetryList.front())) {
+        done(respRetryList.front());
+        respRetryList.pop_front();
+    }
+}
+
+void
+EventQueueBridge::done(PacketPtr pkt)
+{
+    bool empty;
+    {
+        // The packet may be gone already, only its address is compared
+        std::lock_guard<std::mutex> lock(inFlightLock);
+        inFlight.erase(std::find(inFlight.begin(), inFlight.end(), pkt));
+        empty = inFlight.empty();
+    }
+
+    if (empty && drainState() == DrainState::Draining) {
+        DPRINTF(EventQueueBridge, "Done draining\n");
+        signalDrainDone();
+    }
+}
+
+void
+EventQueueBridge::recvFunctional(PacketPtr pkt)
+{
+    EventQueue::ScopedMigration migrate(masterQueue, inParallelMode);
+
+    // With the other thread stopped, the packets in flight can be
+    // checked. A read takes the newest data, a write updates them all
+    // and carries on to the master side.
+    pkt->pushLabel(name());
+    {
+        std::lock_guard<std::mutex> lock(inFlightLock);
+        for (auto i = inFlight.rbegin(); i != inFlight.rend(); ++i) {
+            if (pkt->trySatisfyFunctional(*i)) {
+                pkt->makeResponse();
+                return;
+            }
+        }
+    }
+    pkt->popLabel();
+
+    masterPort.sendFunctional(pkt);
+}
+
+bool
+EventQueueBridge::BridgeSlavePort::recvTimingReq(PacketPtr pkt)
+{
+    bridge.cross(pkt, bridge.masterQueue);
+    return true;
+}
+
+void
+EventQueueBridge::BridgeSlavePort::recvRespRetry()
+{
+    bridge.retryResps();
+}
+
+Tick
+EventQueueBridge::BridgeSlavePort::recvAtomic(PacketPtr pkt)
+{
+    EventQueue::ScopedMigration migrate(bridge.masterQueue, inParallelMode);
+    return bridge.delay + bridge.masterPort.sendAtomic(pkt);
+}
+
+void
+EventQueueBridge::BridgeSlavePort::recvFunctional(PacketPtr pkt)
+{
+    bridge.recvFunctional(pkt);
+}
+
+AddrRangeList
+EventQueueBridge::BridgeSlavePort::getAddrRanges() const
+{
+    return bridge.masterPort.getAddrRanges();
+}
+
+bool
+EventQueueBridge::BridgeMasterPort::recvTimingResp(PacketPtr pkt)
+{
+    bridge.cross(pkt, bridge.slaveQueue);
+    return true;
+}
+
+void
+EventQueueBridge::BridgeMasterPort::recvReqRetry()
+{
+    bridge.retryReqs();
+}
+
+void
+EventQueueBridge::BridgeMasterPort::recvRangeChange()
+{
+    bridge.slavePort.sendRangeChange();
+}
+
+void
+EventQueueBridge::CrossingEvent::process()
+{
+    bridge.deliver(pkt);
+}
+
+const char *
+EventQueueBridge::CrossingEvent::description() const
+{
+    return "event queue bridge crossing";
+}
+
+EventQueueBridge *
+EventQueueBridgeParams::create()
+{
+    return new EventQueueBridge(this);
+}
@@ -0,0 +1,140 @@
+ /*
+ * Copyright EPFL 2024
+ * Rafael Medina Morillas
+ *
+ */
+
+/**
+ * @file
+ * Declaration of a bridge between two event queues, so that two parts of
+ * the memory system can be simulated by different threads.
+ */
+
+#ifndef __MEM_EVENTQ_BRIDGE_HH__
+#define __MEM_EVENTQ_BRIDGE_HH__
+
+#include <deque>
+#include <list>
+#include <mutex>
+
+#include "mem/mem_object.hh"
+#include "mem/port.hh"
+#include "params/EventQueueBridge.hh"
+
+/**
+ * The EventQueueBridge connects a slave side, on the event queue of the
+ * bridge, to a master side on the event queue master_eventq_index. A
+ * timing packet that enters on one side is handed to the other queue
+ * through an event scheduled delay ticks later, and sent from there in
+ * order, waiting for retries if needed. With different queues the delay
+ * is at least the simulation quantum, so the event is merged into
+ * the other queue at the next quantum barrier. The packet is therefore
+ * never seen by both threads at the same time, and the simulation is as
+ * deterministic as with a single queue.
+ *
+ * Atomic and functional accesses migrate to the queue of the master side
+ * for the duration of the call, as the KVM CPU does with its devices.
+ * Functional accesses also check the packets in flight, as the Bridge
+ * does with its queues.
+ * Snoops are not forwarded, the master side is not snooping.
+ */
+class EventQueueBridge : public MemObject
+{
+  protected:
+
+    class BridgeSlavePort : public SlavePort
+    {
+      private:
+        EventQueueBridge& bridge;
+
+      public:
+        BridgeSlavePort(const std::string& _name, EventQueueBridge& _bridge)
+            : SlavePort(_name, &_bridge), bridge(_bridge)
+        { }
+
+      protected:
+        bool recvTimingReq(PacketPtr pkt) override;
+        void recvRespRetry() override;
+        Tick recvAtomic(PacketPtr pkt) override;
+        void recvFunctional(PacketPtr pkt) override;
+        AddrRangeList getAddrRanges() const override;
+    };
+
+    class BridgeMasterPort : public MasterPort
+    {
+      private:
+        EventQueueBridge& bridge;
+
+      public:
+        BridgeMasterPort(const std::string& _name, EventQueueBridge& _bridge)
+            : MasterPort(_name, &_bridge), bridge(_bridge)
+        { }
+
+      protected:
+        bool recvTimingResp(PacketPtr pkt) override;
+        void recvReqRetry() override;
+        void recvRangeChange() override;
+    };
+
+    /**
+     * Event that carries a packet to the other queue, deleted once it
+     * is processed.
+     */
+    class CrossingEvent : public Event
+    {
+      private:
+        EventQueueBridge& bridge;
+        PacketPtr pkt;
+
+      public:
+        CrossingEvent(EventQueueBridge& _bridge, PacketPtr _pkt)
+            : Event(Default_Pri, AutoDelete), bridge(_bridge), pkt(_pkt)
+        { }
+
+        void process() override;
+        const std::string name() const override { return bridge.name(); }
+        const char *description() const override;
+    };
+
+    BridgeSlavePort slavePort;
+    BridgeMasterPort masterPort;
+
+    /** Queue of the slave side, the one of the bridge. */
+    EventQueue *slaveQueue;
+    /** Queue of the master side. */
+    EventQueue *masterQueue;
+
+    Tick delay;
+
+    /** Packets that crossed and wait for a retry, in order. */
+    std::deque<PacketPtr> reqRetryList;
+    std::deque<PacketPtr> respRetryList;
+
+    /**
+     * Packets crossing or waiting for a retry, in both directions, in
+     * the order they entered. Both threads add and remove packets.
+     */
+    std::list<PacketPtr> inFlight;
+    std::mutex inFlightLock;
+
+    void cross(PacketPtr pkt, EventQueue *to);
+    void deliver(PacketPtr pkt);
+    void retryReqs();
+    void retryResps();
+    void done(PacketPtr pkt);
+    void recvFunctional(PacketPtr pkt);
+
+  public:
+
+    EventQueueBridge(const EventQueueBridgeParams *p);
+
+    void init() override;
+    DrainState drain() override;
+
+    BaseMasterPort& getMasterPort(const std::string& if_name,
+                                  PortID idx = InvalidPortID) override;
+    BaseSlavePort& getSlavePort(const std::string& if_name,
+                                PortID idx = InvalidPortID) override;
+};
+
+#endif //__MEM_EVENTQ_BRIDGE_HH__
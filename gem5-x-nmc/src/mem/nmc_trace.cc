@@ -0,0 +1,164 @@
+ /*
+ * Copyright EPFL 2024
+ * Rafael Medina Morillas
+ *
+ */
+
+#include "mem/nmc_trace.hh"
+
+#include "base/logging.hh"
+#include "config/have_protobuf.hh"
+#include "sim/core.hh"
+
+#if HAVE_PROTOBUF
+#include "proto/nmc_trace.pb.h"
+#include "proto/protoio.hh"
+
+NMCTraceRecorder::NMCTraceRecorder(const std::string &filename,
+                                   const std::string &obj_id,
+                                   const AddrRange &range)
+    : stream(new ProtoOutputStream(filename))
+{
+    ProtoMessage::NMCTraceHeader header_msg;
+    header_msg.set_obj_id(obj_id);
+    header_msg.set_tick_freq(SimClock::Frequency);
+    header_msg.set_range_start(range.start());
+    header_msg.set_range_size(range.size());
+    stream->write(header_msg);
+}
+
+NMCTraceRecorder::~NMCTraceRecorder()
+{
+    delete stream;
+}
+
+bool
+NMCTraceRecorder::capture(PacketPtr pkt, NMCTraceRecord &record) const
+{
+    // the snooper supplies the data, the memory does nothing
+    if (pkt->cacheResponding())
+        return false;
+
+    record.tick = curTick();
+    record.cmd = pkt->cmd;
+    record.addr = pkt->getAddr();
+    record.size = pkt->getSize();
+    record.flags = pkt->req->getFlags();
+    record.master = pkt->req->masterId();
+
+    auto m = masters.find(record.master);
+    record.depResponses = m != masters.end() ? m->second.responses : 0;
+    record.depDelay = record.depResponses ?
+        record.tick - m->second.lastResponse : 0;
+
+    if (pkt->isWrite() && pkt->hasData()) {
+        const uint8_t *data = pkt->getConstPtr<uint8_t>();
+        record.data.assign(data, data + record.size);
+    } else {
+        record.data.clear();
+    }
+    return true;
+}
+
+void
+NMCTraceRecorder::request(PacketPtr pkt, const NMCTraceRecord &record)
+{
+    ProtoMessage::NMCTraceRequest req_msg;
+    req_msg.set_tick(record.tick);
+    req_msg.set_cmd(record.cmd.toInt());
+    req_msg.set_addr(record.addr);
+    req_msg.set_size(record.size);
+    req_msg.set_flags(record.flags);
+    req_msg.set_master(record.master);
+    if (record.depResponses) {
+        req_msg.set_dep_responses(record.depResponses);
+        req_msg.set_dep_delay(record.depDelay);
+    }
+    if (!record.data.empty())
+        req_msg.set_data(record.data.data(), record.data.size());
+    stream->write(req_msg);
+
+    if (record.cmd.needsResponse())
+        pending[pkt] = record.master;
+}
+
+void
+NMCTraceRecorder::response(PacketPtr pkt)
+{
+    auto p = pending.find(pkt);
+    if (p == pending.end())
+        return;
+
+    MasterState &m = masters[p->second];
+    ++m.responses;
+    m.lastResponse = curTick();
+    pending.erase(p);
+}
+
+NMCTraceReader::NMCTraceReader(const std::string &filename)
+    : stream(new ProtoInputStream(filename))
+{
+    ProtoMessage::NMCTraceHeader header_msg;
+    if (!stream->read(header_msg))
+        fatal("Failed to read the header of NMC trace %s\n", filename);
+
+    tickFreq = header_msg.tick_freq();
+    objId = header_msg.obj_id();
+    range = RangeSize(header_msg.range_start(), header_msg.range_size());
+}
+
+NMCTraceReader::~NMCTraceReader()
+{
+    delete stream;
+}
+
+bool
+NMCTraceReader::read(NMCTraceRecord &record)
+{
+    ProtoMessage::NMCTraceRequest req_msg;
+    if (!stream->read(req_msg))
+        return false;
+
+    record.tick = req_msg.tick();
+    record.cmd = MemCmd((MemCmd::Command)req_msg.cmd());
+    record.addr = req_msg.addr();
+    record.size = req_msg.size();
+    record.flags = req_msg.flags();
+    record.master = req_msg.master();
+    record.depResponses = req_msg.dep_responses();
+    record.depDelay = req_msg.dep_delay();
+    record.data.assign(req_msg.data().begin(), req_msg.data().end());
+    return true;
+}
+
+#else
+
+NMCTraceRecorder::NMCTraceRecorder(const std::string &filename,
+                                   const std::string &obj_id,
+                                   const AddrRange &range)
+    : stream(nullptr)
+{
+    fatal("Recording NMC traces requires gem5 built with protobuf\n");
+}
+
+NMCTraceRecorder::~NMCTraceRecorder()
+{
+}
+
+bool
+NMCTraceRecorder::capture(PacketPtr pkt, NMCTraceRecord &record) const
+{
+    return false;
+}
+
+void
+NMCTraceRecorder::request(PacketPtr pkt, const NMCTraceRecord &record)
+{
+}
+
+void
+NMCTraceRecorder::response(PacketPtr pkt)
+{
+}
+
+#endif // HAVE_PROTOBUF
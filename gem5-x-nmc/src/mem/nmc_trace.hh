@@ -0,0 +1,98 @@
+ /*
+ * Copyright EPFL 2024
+ * Rafael Medina Morillas
+ *
+ */
+
+/**
+ * @file
+ * Traces of the requests to an NMC memory, recorded by Ramulator and
+ * replayed by the NMCTracePlayer without the CPUs, see nmc_trace.proto.
+ */
+
+#ifndef __MEM_NMC_TRACE_HH__
+#define __MEM_NMC_TRACE_HH__
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "base/addr_range.hh"
+#include "base/types.hh"
+#include "mem/packet.hh"
+
+class ProtoInputStream;
+class ProtoOutputStream;
+
+/** A request of the trace, see NMCTraceRequest in nmc_trace.proto. */
+struct NMCTraceRecord
+{
+    Tick tick;
+    MemCmd cmd;
+    Addr addr;
+    unsigned size;
+    Request::FlagsType flags;
+    MasterID master;
+    uint64_t depResponses;
+    Tick depDelay;
+    std::vector<uint8_t> data;
+};
+
+/**
+ * Records the requests accepted by a memory and the responses it sends.
+ * A request depends on the last response its master received before it
+ * arrived, the dependency the player waits for.
+ */
+class NMCTraceRecorder
+{
+  private:
+    ProtoOutputStream *stream;
+
+    struct MasterState
+    {
+        uint64_t responses;
+        Tick lastResponse;
+    };
+    std::unordered_map<MasterID, MasterState> masters;
+
+    /** Masters of the requests waiting for their response. */
+    std::unordered_map<PacketPtr, MasterID> pending;
+
+  public:
+    NMCTraceRecorder(const std::string &filename, const std::string &obj_id,
+                     const AddrRange &range);
+    ~NMCTraceRecorder();
+
+    /**
+     * Fill the record of a request before it is handled, false if it is
+     * not to be recorded.
+     */
+    bool capture(PacketPtr pkt, NMCTraceRecord &record) const;
+
+    /** Write the record of a request the memory accepted. */
+    void request(PacketPtr pkt, const NMCTraceRecord &record);
+
+    /** Account a response, before it is sent. */
+    void response(PacketPtr pkt);
+};
+
+/** Reads the requests of a trace in order. */
+class NMCTraceReader
+{
+  private:
+    ProtoInputStream *stream;
+
+  public:
+    Tick tickFreq;
+    std::string objId;
+    AddrRange range;
+
+    NMCTraceReader(const std::string &filename);
+    ~NMCTraceReader();
+
+    /** Read the next request, false at the end of the trace. */
+    bool read(NMCTraceRecord &record);
+};
+
+#endif //__MEM_NMC_TRACE_HH__
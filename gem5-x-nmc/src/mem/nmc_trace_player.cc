@@ -0,0 +1,230 @@
+ /*
+ * Copyright EPFL 2024
+ * Rafael Medina Morillas
+ *
+ */
+
+/**
+ * @file
+ * Definition of a player of the NMC traces recorded by Ramulator.
+ */
+
+#include "mem/nmc_trace_player.hh"
+
+#include <algorithm>
+
+#include "base/trace.hh"
+#include "debug/NMCTrace.hh"
+#include "sim/sim_exit.hh"
+#include "sim/system.hh"
+
+NMCTracePlayer::NMCTracePlayer(const NMCTracePlayerParams *p)
+    : MemObject(p),
+      port(p->name + ".port", *this),
+      trace(p->trace_file),
+      masterId(p->system->getMasterId(this)),
+      nextValid(false),
+      retryPkt(nullptr),
+      waiting(false),
+      lastIssued(0),
+      lastRecorded(0),
+      issueEvent([this]{ issue(); }, name())
+{
+}
+
+void
+NMCTracePlayer::init()
+{
+    if (!port.isConnected())
+        fatal("NMC trace player %s is not connected.\n", name());
+
+    if (trace.tickFreq != SimClock::Frequency)
+        fatal("NMC trace of %s was recorded with a different tick "
+              "frequency %d\n", trace.objId, trace.tickFreq);
+
+    bool covered = false;
+    for (const auto &range : port.getAddrRanges())
+        covered = covered || trace.range.isSubset(range);
+    if (!covered)
+        fatal("NMC trace of %s was recorded for the range %s, not served "
+              "by the memory of %s\n", trace.objId, trace.range.to_string(),
+              name());
+}
+
+void
+NMCTracePlayer::startup()
+{
+    nextValid = trace.read(next);
+    lastIssued = curTick();
+    lastRecorded = nextValid ? next.tick : 0;
+    schedule(issueEvent, curTick());
+}
+
+void
+NMCTracePlayer::regStats()
+{
+    MemObject::regStats();
+
+    numRequests
+        .name(name() + ".requests")
+        .desc("Requests of the trace sent to the memory")
+        ;
+    numResponses
+        .name(name() + ".responses")
+        .desc("Responses received from the memory")
+        ;
+    dependencyStalls
+        .name(name() + ".dependency_stalls")
+        .desc("Requests that waited for a response of their master")
+        ;
+    totalLatency
+        .name(name() + ".total_latency")
+        .desc("Total latency of the requests, from sent to responded (ticks)")
+        ;
+    avgLatency
+        .name(name() + ".avg_latency")
+        .desc("Average latency of the requests (ticks)")
+        .precision(2)
+        ;
+    avgLatency = totalLatency / numResponses;
+}
+
+BaseMasterPort&
+NMCTracePlayer::getMasterPort(const std::string& if_name, PortID idx)
+{
+    if (if_name == "port")
+        return port;
+    else
+        return MemObject::getMasterPort(if_name, idx);
+}
+
+Tick
+NMCTracePlayer::ready()
+{
+    // without dependency, as long after the previous request as recorded
+    if (!next.depResponses)
+        return lastIssued + (next.tick - lastRecorded);
+
+    MasterState &m = masters[next.master];
+    if (m.responses < next.depResponses)
+        return MaxTick;
+
+    // the dependencies of a master only move forward, the ticks of the
+    // responses before this one are not needed anymore
+    while (m.first < next.depResponses) {
+        m.ticks.pop_front();
+        ++m.first;
+    }
+    return std::max(lastIssued, m.ticks.front() + next.depDelay);
+}
+
+void
+NMCTracePlayer::issue()
+{
+    while (nextValid && !retryPkt) {
+        Tick when = ready();
+        if (when == MaxTick) {
+            // sent again on a response of the master
+            if (!waiting)
+                ++dependencyStalls;
+            waiting = true;
+            return;
+        }
+        waiting = false;
+
+        if (when > curTick()) {
+            schedule(issueEvent, when);
+            return;
+        }
+
+        RequestPtr req = makeRequest(next.addr, next.size, next.flags,
+                                     masterId);
+        PacketPtr pkt = new Packet(req, next.cmd);
+        if (pkt->isRead() || pkt->isWrite())
+            pkt->allocate();
+        if (!next.data.empty())
+            pkt->setData(next.data.data());
+
+        if (!port.sendTimingReq(pkt)) {
+            DPRINTF(NMCTrace, "%s refused, waiting for a retry\n",
+                    pkt->print());
+            retryPkt = pkt;
+            return;
+        }
+        sent(pkt);
+    }
+
+    checkDone();
+}
+
+void
+NMCTracePlayer::sent(PacketPtr pkt)
+{
+    DPRINTF(NMCTrace, "%s sent, recorded at %d\n", pkt->print(), next.tick);
+
+    // the memory deletes the packets that need no response
+    if (next.cmd.needsResponse())
+        pending[pkt] = Pending{next.master, curTick()};
+
+    ++numRequests;
+    lastIssued = curTick();
+    lastRecorded = next.tick;
+    nextValid = trace.read(next);
+}
+
+void
+NMCTracePlayer::recvResponse(PacketPtr pkt)
+{
+    auto p = pending.find(pkt);
+    assert(p != pending.end());
+
+    DPRINTF(NMCTrace, "%s responded\n", pkt->print());
+
+    ++numResponses;
+    totalLatency += curTick() - p->second.issued;
+
+    MasterState &m = masters[p->second.master];
+    ++m.responses;
+    m.ticks.push_back(curTick());
+
+    pending.erase(p);
+    delete pkt;
+
+    if (waiting)
+        issue();
+    else
+        checkDone();
+}
+
+void
+NMCTracePlayer::checkDone()
+{
+    if (!nextValid && !retryPkt && pending.empty())
+        exitSimLoop("end of NMC trace");
+}
+
+bool
+NMCTracePlayer::PlayerMasterPort::recvTimingResp(PacketPtr pkt)
+{
+    player.recvResponse(pkt);
+    return true;
+}
+
+void
+NMCTracePlayer::PlayerMasterPort::recvReqRetry()
+{
+    assert(player.retryPkt);
+    if (!sendTimingReq(player.retryPkt))
+        return;
+
+    PacketPtr pkt = player.retryPkt;
+    player.retryPkt = nullptr;
+    player.sent(pkt);
+    player.issue();
+}
+
+NMCTracePlayer *
+NMCTracePlayerParams::create()
+{
+    return new NMCTracePlayer(this);
+}
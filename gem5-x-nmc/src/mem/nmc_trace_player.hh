@@ -0,0 +1,119 @@
+ /*
+ * Copyright EPFL 2024
+ * Rafael Medina Morillas
+ *
+ */
+
+/**
+ * @file
+ * Declaration of a player of the NMC traces recorded by Ramulator.
+ */
+
+#ifndef __MEM_NMC_TRACE_PLAYER_HH__
+#define __MEM_NMC_TRACE_PLAYER_HH__
+
+#include <deque>
+#include <unordered_map>
+
+#include "base/statistics.hh"
+#include "mem/mem_object.hh"
+#include "mem/nmc_trace.hh"
+#include "mem/port.hh"
+#include "params/NMCTracePlayer.hh"
+
+/**
+ * The NMCTracePlayer sends the requests of a trace recorded at an NMC
+ * memory, in the order they were recorded, to a memory with another
+ * configuration of Ramulator or of the NMC cores. A request that
+ * depended on a response of its master is sent when its master received
+ * as many responses as it had when the request was recorded, as long
+ * after the last of them as it was recorded. The other requests keep
+ * the time elapsed since the previous request. The responses of a
+ * faster memory therefore bring the following requests forward, as a
+ * CPU would, without simulating it.
+ *
+ * The simulation exits when the responses to all the requests of the
+ * trace are received.
+ */
+class NMCTracePlayer : public MemObject
+{
+  protected:
+
+    class PlayerMasterPort : public MasterPort
+    {
+      private:
+        NMCTracePlayer& player;
+
+      public:
+        PlayerMasterPort(const std::string& _name, NMCTracePlayer& _player)
+            : MasterPort(_name, &_player), player(_player)
+        { }
+
+      protected:
+        bool recvTimingResp(PacketPtr pkt) override;
+        void recvReqRetry() override;
+    };
+
+    /** Responses received by a master of the trace. */
+    struct MasterState
+    {
+        uint64_t responses;
+        /** Ticks of the responses from number first on. */
+        uint64_t first;
+        std::deque<Tick> ticks;
+
+        MasterState() : responses(0), first(1) { }
+    };
+
+    struct Pending
+    {
+        MasterID master;
+        Tick issued;
+    };
+
+    PlayerMasterPort port;
+
+    NMCTraceReader trace;
+    MasterID masterId;
+
+    NMCTraceRecord next;
+    bool nextValid;
+    /** Packet of the next request, refused by the memory. */
+    PacketPtr retryPkt;
+    /** Whether the next request waits for a response of its master. */
+    bool waiting;
+
+    /** Replay and recorded ticks of the previous request. */
+    Tick lastIssued;
+    Tick lastRecorded;
+
+    std::unordered_map<MasterID, MasterState> masters;
+    std::unordered_map<PacketPtr, Pending> pending;
+
+    void issue();
+    Tick ready();
+    void sent(PacketPtr pkt);
+    void recvResponse(PacketPtr pkt);
+    void checkDone();
+
+    EventFunctionWrapper issueEvent;
+
+    Stats::Scalar numRequests;
+    Stats::Scalar numResponses;
+    Stats::Scalar dependencyStalls;
+    Stats::Scalar totalLatency;
+    Stats::Formula avgLatency;
+
+  public:
+
+    NMCTracePlayer(const NMCTracePlayerParams *p);
+
+    void init() override;
+    void startup() override;
+    void regStats() override;
+
+    BaseMasterPort& getMasterPort(const std::string& if_name,
+                                  PortID idx = InvalidPortID) override;
+};
+
+#endif //__MEM_NMC_TRACE_PLAYER_HH__
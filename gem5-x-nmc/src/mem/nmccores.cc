@@ -6,6 +6,9 @@
  */
 
 #include "mem/nmccores.hh"
+#include "sim/sim_exit.hh"
+#include "sim/stats.hh"
+#include <csignal>
 #include <iostream>
 //#include <libexplain/execvp.h>
 
@@ -20,7 +23,21 @@ NMCcores::NMCcores(const Params *params):
     sharedMemPtr(nullptr),
     sharedCnmInfo(nullptr),
     sharedLastCmd(nullptr),
-    bankParity(0), addrRemoveBABG(0)
+    sharedActivity(nullptr),
+    lastActivity(),
+    sharedMemBytes(CNM_ACTIVITY_OFFSET(NUM_SIM_CHANNEL*sizeof(FileLine)) + sizeof(cnm_activity)),
+    bankParity(0), addrRemoveBABG(0),
+    systemcSyncs(0), systemcSeconds(0),
+    multEnergy(params->mult_energy),
+    addEnergy(params->add_energy),
+    grfReadEnergy(params->grf_read_energy),
+    grfWriteEnergy(params->grf_write_energy),
+    srfReadEnergy(params->srf_read_energy),
+    srfWriteEnergy(params->srf_write_energy),
+    instrEnergy(params->instr_energy),
+    crfWriteEnergy(params->crf_write_energy),
+    binary(params->binary),
+    exitOnModeChange(params->exit_on_mode_change)
 {
     // Generate simulation-independent semaphore and shared memory names
     gem5_pid = getpid();
@@ -45,7 +62,7 @@ NMCcores::NMCcores(const Params *params):
         perror("Cannot open shared memory descriptor");
     }
 
-    sharedMemPtr = (void*) mmap(NULL, NUM_SIM_CHANNEL*sizeof(FileLine) + sizeof(uint8_t), PROT_READ | PROT_WRITE, MAP_SHARED, shm_fd, 0);
+    sharedMemPtr = (void*) mmap(NULL, sharedMemBytes, PROT_READ | PROT_WRITE, MAP_SHARED, shm_fd, 0);
     if (sharedMemPtr == MAP_FAILED) {
 	    printf("error is %d\n", errno);
 	    perror("Cannot MAP");
@@ -54,8 +71,9 @@ NMCcores::NMCcores(const Params *params):
     }
     sharedCnmInfo = (FileLine*) sharedMemPtr;
     sharedLastCmd = ((uint8_t*) sharedMemPtr) + NUM_SIM_CHANNEL*sizeof(FileLine);
+    sharedActivity = (cnm_activity*) (((uint8_t*) sharedMemPtr) + CNM_ACTIVITY_OFFSET(NUM_SIM_CHANNEL*sizeof(FileLine)));
 
-    int result = ftruncate(shm_fd, NUM_SIM_CHANNEL*sizeof(FileLine) + sizeof(uint8_t));
+    int result = ftruncate(shm_fd, sharedMemBytes);
     
     initSharedMemory();
 
@@ -81,11 +99,9 @@ NMCcores::NMCcores(const Params *params):
 
     pid = fork();
 
-    // TODO automate this
     if (pid == 0) {
         std::string scPath = simout.resolve("SystemC" + gem5_pid_string + ".results");
-        execl("/gem5-X-NMC/gem5-x-nmc/ext/NMCcores/nmc-cores", 
-              "/gem5-X-NMC/gem5-x-nmc/ext/NMCcores/nmc-cores", scPath.c_str(), gem5_pid_string.c_str(),  nullptr);
+        execl(binary.c_str(), binary.c_str(), scPath.c_str(), gem5_pid_string.c_str(),  nullptr);
         std::cout << "error with execl" << std::endl;
     } else {
         std::cout << "==============================================================================================================" << std::endl;
@@ -104,9 +120,32 @@ NMCcores::~NMCcores()
     delete nmccoresExitCallback;
 }
 
-void NMCcores::rcvCnmWriteData() {
+void NMCcores::syncSystemC() {
+    auto start = std::chrono::steady_clock::now();
     sem_post(semaphore1);
     sem_wait(semaphore2);
+    systemcSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    systemcSyncs++;
+    updateActivity();
+}
+
+void NMCcores::updateActivity() {
+    cnm_activity now = *sharedActivity;
+
+    nmcInstructions += now.instructions - lastActivity.instructions;
+    nmcMultOps += now.mult_ops - lastActivity.mult_ops;
+    nmcAddOps += now.add_ops - lastActivity.add_ops;
+    nmcGrfReads += now.grf_reads - lastActivity.grf_reads;
+    nmcGrfWrites += now.grf_writes - lastActivity.grf_writes;
+    nmcSrfReads += now.srf_reads - lastActivity.srf_reads;
+    nmcSrfWrites += now.srf_writes - lastActivity.srf_writes;
+    nmcCrfWrites += now.crf_writes - lastActivity.crf_writes;
+
+    lastActivity = now;
+}
+
+void NMCcores::rcvCnmWriteData() {
+    syncSystemC();
 
     uint channel = channelCnmWrite.front();
     channelCnmWrite.pop_front();
@@ -129,6 +168,7 @@ void NMCcores::rcvCnmWriteData() {
             for (int j = 0; j < NUM_BANK; j+=2) {   // Loop over even banks
                 // std::cout << std::showbase << std::hex << "Even address = " << localCnmInfo[channel].address  << "\t" << localCnmInfo[channel].dataArray[DWORDS_PER_COL*(NUM_BANK/2*i+(j/2))] << std::endl; 
                 memcpy((uint8_t*)(addrRemoveBABG + (i << SHIFT_BG) + (j << SHIFT_BANK)), &localCnmInfo[channel].dataArray[DWORDS_PER_COL*(NUM_BANK/2*i+(j/2))], DWORDS_PER_COL*sizeof(uint64_t));
+                notifyCnmWrite((uint8_t*)(addrRemoveBABG + (i << SHIFT_BG) + (j << SHIFT_BANK)), DWORDS_PER_COL*sizeof(uint64_t));
             }
         }
     } else {    // Odd bank
@@ -136,14 +176,23 @@ void NMCcores::rcvCnmWriteData() {
             for (int j = 1; j < NUM_BANK; j+=2) {   // Loop over odd banks
                 // std::cout << std::showbase << std::hex << "Odd address = " << localCnmInfo[channel].address  << "\t" << localCnmInfo[channel].dataArray[DWORDS_PER_COL*(NUM_BANK/2*i+((j-1)/2))] << std::endl; 
                 memcpy((uint8_t*)(addrRemoveBABG + (i << SHIFT_BG) + (j << SHIFT_BANK)), &localCnmInfo[channel].dataArray[DWORDS_PER_COL*(NUM_BANK/2*i+((j-1)/2))], DWORDS_PER_COL*sizeof(uint64_t));
+                notifyCnmWrite((uint8_t*)(addrRemoveBABG + (i << SHIFT_BG) + (j << SHIFT_BANK)), DWORDS_PER_COL*sizeof(uint64_t));
             }
         }
     }
 #else
     memcpy(hostAddrBase+localCnmInfo[channel].address, localCnmInfo[channel].dataArray, DWORDS_PER_COL*CORES_PER_PCH*sizeof(uint64_t));
+    notifyCnmWrite(hostAddrBase+localCnmInfo[channel].address, DWORDS_PER_COL*CORES_PER_PCH*sizeof(uint64_t));
 #endif
 }
 
+// The data of the CnM PUs is copied in the memory behind the caches, the callback
+// gets the physical address so the copies cached by the host can be invalidated
+void NMCcores::notifyCnmWrite(uint8_t* hostAddr, unsigned int size) {
+    if (cnmWriteCallback)
+        cnmWriteCallback(hostAddr - hostAddrBase + ADDR_OFFSET, size);
+}
+
 void NMCcores::copyFileLine (FileLine* dest, FileLine* src) {
     dest->address = src->address;
     for(int j = 0; j < DWORDS_PER_COL*CORES_PER_PCH; j++){
@@ -168,40 +217,54 @@ void NMCcores::packetInfo(PacketPtr pkt){
         return;
     }
 
+    // The data of a write of the CnM PUs is still in the shared memory until its
+    // cycle has passed, collect it before the next command overwrites it
+    if (advanceOneCycle_event.scheduled()) {
+        deschedule(advanceOneCycle_event);
+        rcvCnmWriteData();
+    }
+
     // Check if switching memory mode
     if (pkt->getAddr() >= MODE_CHANGE_START && pkt->getAddr() <= MODE_CHANGE_END) {
+        bool wasNmcMode = inNmcMode();
+        // the mode-change addresses of the channels are GLOBAL_OFFSET apart
+        uint modeChannel = (pkt->getAddr() - MODE_CHANGE_START) >> GLOBAL_OFFSET;
+        channelMode[modeChannel] = !channelMode[modeChannel];
         nmcMode[channel] = nmcMode[channel] ? 0 : 1;
         std::cout << "Changed channel " << channel << " to NMC mode " << uint(nmcMode[channel]) << std::endl;
         sharedCnmInfo[channel].nmcMode = nmcMode[channel];
         localCnmInfo[channel].nmcMode = nmcMode[channel];
+        // The exit event runs before the next instruction of the host
+        if (exitOnModeChange && wasNmcMode != inNmcMode())
+            exitSimLoop(wasNmcMode ? "nmc region end" : "nmc region begin");
         return; // Do not process the packet further
     }
     //GRF
     if (nmcMode[channel] && pkt->getAddr() >= GRFA_START && pkt->getAddr() < GRFB_END) {
 
-        uint dqCycle = (pkt->getAddr() % (GRF_WIDTH/8)) / (DQ_BITS / 8);
+        // A store carries one DQ word, a write combined by Ramulator the whole GRF line
+        for (unsigned offset = 0; offset < pkt->getSize(); offset += DQ_BITS / 8) {
+            Addr addr = pkt->getAddr() + offset;
+            uint dqCycle = (addr % (GRF_WIDTH/8)) / (DQ_BITS / 8);
 
-        if (!dqCycle) {
-            addr_temp[channel] = pkt->getAddr();    // Store the address of the first byte of the GRF
-        }
-        temp[channel][dqCycle] = *(pkt->getConstPtr<uint64_t>());
+            if (!dqCycle) {
+                addr_temp[channel] = addr;    // Store the address of the first byte of the GRF
+            }
+            temp[channel][dqCycle] = pkt->getConstPtr<uint64_t>()[offset / sizeof(uint64_t)];
         
-        if(dqCycle == DQ_CLK - 1) {
+            if(dqCycle == DQ_CLK - 1) {
+
+                localCnmInfo[channel].address = (addr_temp[channel] - ADDR_OFFSET);
+                localCnmInfo[channel].RDcmd = pkt->isRead();
+                for (int i = 0; i < DQ_CLK; i++) {
+                    localCnmInfo[channel].dataArray[i] = temp[channel][i];
+                }
+                localCnmInfo[channel].issuedTick = curTick();
+                localCnmInfo[channel].simCycle = 0;
 
-            localCnmInfo[channel].address = (addr_temp[channel] - ADDR_OFFSET);
-            localCnmInfo[channel].RDcmd = pkt->isRead();
-            for (int i = 0; i < DQ_CLK; i++) {
-                localCnmInfo[channel].dataArray[i] = temp[channel][i];
+                copyFileLine(&sharedCnmInfo[channel], &localCnmInfo[channel]);
+                syncSystemC();
             }
-            localCnmInfo[channel].issuedTick = curTick();
-            localCnmInfo[channel].simCycle = 0;
-
-            copyFileLine(&sharedCnmInfo[channel], &localCnmInfo[channel]);
-            // std::cout << "send to SystemC" << std::endl;
-            // printFileLine(&localCnmInfo[channel]);
-            // std::cout << std::endl;
-            sem_post(semaphore1);
-            sem_wait(semaphore2);
         }
     //SRF and CRF
     } else if (nmcMode[channel] && pkt->getAddr() >= CRF_START && pkt->getAddr() < GRFA_START) {
@@ -215,8 +278,7 @@ void NMCcores::packetInfo(PacketPtr pkt){
         // std::cout << "send to SystemC" << std::endl;
         // printFileLine(&localCnmInfo[channel]);
         // std::cout << std::endl;
-        sem_post(semaphore1);
-        sem_wait(semaphore2);
+        syncSystemC();
     // EXEC 
     } else if (nmcMode[channel] && pkt->getAddr() >= EXEC_START && pkt->getAddr() < EXEC_END) {
         hostAddrBase = pmemAddr_copy - RangeStart_copy + ADDR_OFFSET;
@@ -261,8 +323,7 @@ void NMCcores::packetInfo(PacketPtr pkt){
         // std::cout << "send to SystemC" << std::endl;
         // printFileLine(&localCnmInfo[channel]);
         // std::cout << std::endl;
-        sem_post(semaphore1);
-        sem_wait(semaphore2);
+        syncSystemC();
         if (pkt->isWrite()) {
             // std::cout << "Address " << pkt->getAddr() << "localCnmInfo.address" << localCnmInfo[channel].address << std::endl;
             channelCnmWrite.push_back(channel);
@@ -272,6 +333,19 @@ void NMCcores::packetInfo(PacketPtr pkt){
         
 }
 
+void NMCcores::atomicPacketInfo(PacketPtr pkt) {
+    if (pkt->getAddr() >= MODE_CHANGE_START && pkt->getAddr() <= MODE_CHANGE_END)
+        packetInfo(pkt);
+}
+
+bool NMCcores::inNmcMode() const {
+    for (int i = 0; i < NUM_CHANNEL; i++) {
+        if (channelMode[i])
+            return true;
+    }
+    return false;
+}
+
 void NMCcores::copyhostAddr(uint8_t *hostAddrPart) {
     pmemAddr_copy = hostAddrPart;
     // std::cout << "Copied pmemAddr " << std::hex << std::showbase << (uint64_t) pmemAddr_copy << std::endl;
@@ -281,11 +355,73 @@ void NMCcores::copyRangeStart(uint64_t rngStrt) {
     RangeStart_copy = rngStrt;
 }
 
+void NMCcores::setWriteCallback(std::function<void(Addr, unsigned int)> cb) {
+    cnmWriteCallback = cb;
+}
+
 void NMCcores::printSem() {
     std::cout << "sem1 " << semaphore1 << std::endl;
     std::cout << "sem2 " << semaphore2 << std::endl;
 }
 
+void
+NMCcores::regStats()
+{
+    SimObject::regStats();
+
+    using namespace Stats;
+
+    nmcInstructions
+        .name(name() + ".instructions")
+        .desc("Number of CRF instructions executed by the NMC cores");
+    nmcMultOps
+        .name(name() + ".mult_ops")
+        .desc("Number of FPU multiplications (per SIMD lane)");
+    nmcAddOps
+        .name(name() + ".add_ops")
+        .desc("Number of FPU additions (per SIMD lane)");
+    nmcGrfReads
+        .name(name() + ".grf_reads")
+        .desc("Number of GRF register reads");
+    nmcGrfWrites
+        .name(name() + ".grf_writes")
+        .desc("Number of GRF register writes");
+    nmcSrfReads
+        .name(name() + ".srf_reads")
+        .desc("Number of SRF register reads");
+    nmcSrfWrites
+        .name(name() + ".srf_writes")
+        .desc("Number of SRF register writes");
+    nmcCrfWrites
+        .name(name() + ".crf_writes")
+        .desc("Number of CRF writes from the host");
+
+    nmcFpuEnergy
+        .name(name() + ".fpu_energy")
+        .desc("Energy of the FPU operations (pJ)")
+        .precision(0);
+    nmcRfEnergy
+        .name(name() + ".rf_energy")
+        .desc("Energy of the register file accesses and instruction fetches (pJ)")
+        .precision(0);
+    nmcEnergy
+        .name(name() + ".energy")
+        .desc("Total energy of the NMC cores (pJ)")
+        .precision(0);
+    nmcPower
+        .name(name() + ".power")
+        .desc("Average power of the NMC cores (mW)")
+        .precision(4)
+        .flags(nonan);
+
+    nmcFpuEnergy = nmcMultOps * multEnergy + nmcAddOps * addEnergy;
+    nmcRfEnergy = nmcGrfReads * grfReadEnergy + nmcGrfWrites * grfWriteEnergy +
+                  nmcSrfReads * srfReadEnergy + nmcSrfWrites * srfWriteEnergy +
+                  nmcInstructions * instrEnergy + nmcCrfWrites * crfWriteEnergy;
+    nmcEnergy = nmcFpuEnergy + nmcRfEnergy;
+    nmcPower = nmcEnergy / simSeconds / 1e9;
+}
+
 NMCcores*
 NMCcoresParams::create()
 {
@@ -294,6 +430,9 @@ NMCcoresParams::create()
 
 void NMCcores::initSharedMemory() {
     *sharedLastCmd = 0;
+    *sharedActivity = cnm_activity();
+    for (int i = 0; i < NUM_CHANNEL; i++)
+        channelMode[i] = false;
     for (int i = 0; i < NUM_SIM_CHANNEL; i++) {
         nmcMode[i] = 0; // Initialize all channels at memory mode
         sharedCnmInfo[i].address = 0;
@@ -309,15 +448,25 @@ void NMCcores::initSharedMemory() {
 
 void NMCcores::endSystemCSim() {
     std::cout << "NMCcores ExitCallback" << std::endl;
+    std::cout << "NMCcores synchronizations with SystemC: " << std::dec << systemcSyncs << std::endl;
+    std::cout << "NMCcores host seconds blocked on SystemC: " << systemcSeconds << std::endl;
+
+    if (systemcSyncs) {
+        *sharedLastCmd = 1;
+
+        sem_post(NMCcores::semaphore1);
+        sem_wait(NMCcores::semaphore2);
+        updateActivity();   // Last commands, executed after the final handshake
+    } else {
+        // The SystemC model only stops once a channel has been in NMC mode,
+        // without any command it would never answer the final handshake
+        kill(pid, SIGTERM);
+        waitpid(pid, nullptr, 0);
+    }
 
-    *sharedLastCmd = 1;
-    
-    sem_post(NMCcores::semaphore1);
-    sem_wait(NMCcores::semaphore2);
-     
     sem_unlink(NMCcores::semName1.c_str());
     sem_unlink(NMCcores::semName2.c_str());
-    munmap(NMCcores::sharedMemPtr, NUM_SIM_CHANNEL*sizeof(FileLine) + sizeof(uint8_t));
+    munmap(NMCcores::sharedMemPtr, sharedMemBytes);
     shm_unlink(shmName.c_str());
     // kill(pid, SIGTERM);
     std::cout << "unmapped everything" << std::endl;
@@ -30,9 +30,12 @@
 #include <stdlib.h> // for exit()
 #include <stdint.h>
 #include <errno.h>
+#include <chrono>
+#include <functional>
 // TODO check how to clean this up
 #include "../../ext/NMCcores/NMCcores/src/defs.h"
 #include "../../ext/NMCcores/NMCcores/src/opcodes.h"
+#include "../../ext/NMCcores/NMCcores/src/cnm_activity.h"
 
 // TODO make this a parameter from cmd line
 #define NUM_SIM_CHANNEL 1  // To speed up simulation, the number of simulated CnM channels can be limited
@@ -66,6 +69,7 @@
 #define SHIFT_BANK          (GLOBAL_OFFSET + CHANNEL_BITS + COL_BITS + RANK_BITS + BG_BITS)   // Shifts to the bank bits
 
 #include "base/callback.hh"
+#include "base/statistics.hh"
 
 class NMCcores : public SimObject 
 {
@@ -73,6 +77,8 @@ class NMCcores : public SimObject
 
         void rcvCnmWriteData(); // Receives the data written by the CnM PUs in exec region, exactly one cycle after the access
 
+        void syncSystemC();     // Hands the shared memory to SystemC and blocks until it is given back
+
         EventFunctionWrapper advanceOneCycle_event;
 
         uint8_t *pmemAddr_copy;
@@ -122,9 +128,13 @@ class NMCcores : public SimObject
         void* sharedMemPtr;
         FileLine* sharedCnmInfo;
         uint8_t* sharedLastCmd;
+        cnm_activity* sharedActivity;
+        cnm_activity lastActivity;  // Counters seen at the previous synchronization
+        size_t sharedMemBytes;
         FileLine localCnmInfo[NUM_SIM_CHANNEL];
 
         uint8_t nmcMode[NUM_SIM_CHANNEL];  // Tracks the NMC mode of each channel
+        bool channelMode[NUM_CHANNEL];     // NMC mode of all the channels, also the ones not simulated, for inNmcMode
 
         uint64_t temp[NUM_SIM_CHANNEL][DQ_CLK]; // Stores the column data for each channel
         Addr addr_temp[NUM_SIM_CHANNEL];        // Stores the address of the column data for each channel
@@ -133,6 +143,42 @@ class NMCcores : public SimObject
         Addr addrRemoveBABG;
 
         std::deque<uint> channelCnmWrite;
+
+        std::function<void(Addr, unsigned int)> cnmWriteCallback;   // Told the address and size of every write of the CnM PUs
+        void notifyCnmWrite(uint8_t* hostAddr, unsigned int size);
+
+        uint64_t systemcSyncs;  // Number of handshakes with SystemC
+        double systemcSeconds;  // Host time blocked in the handshakes, i.e. SystemC simulation plus IPC
+
+        void updateActivity();  // Adds the activity of the cores since the previous synchronization to the stats
+
+        // Energy per operation (pJ)
+        const double multEnergy;
+        const double addEnergy;
+        const double grfReadEnergy;
+        const double grfWriteEnergy;
+        const double srfReadEnergy;
+        const double srfWriteEnergy;
+        const double instrEnergy;
+        const double crfWriteEnergy;
+
+        const std::string binary;   // SystemC model of the NMC cores run in the child process
+        const bool exitOnModeChange;  // Exits the simulation loop at the start and end of the NMC regions
+
+        // Activity of the NMC cores, all channels
+        Stats::Scalar nmcInstructions;
+        Stats::Scalar nmcMultOps;
+        Stats::Scalar nmcAddOps;
+        Stats::Scalar nmcGrfReads;
+        Stats::Scalar nmcGrfWrites;
+        Stats::Scalar nmcSrfReads;
+        Stats::Scalar nmcSrfWrites;
+        Stats::Scalar nmcCrfWrites;
+
+        Stats::Formula nmcFpuEnergy;
+        Stats::Formula nmcRfEnergy;
+        Stats::Formula nmcEnergy;
+        Stats::Formula nmcPower;
         
     public:
 
@@ -140,12 +186,20 @@ class NMCcores : public SimObject
 
         NMCcores(const Params *params);
 
+        void regStats() override;
+
         void packetInfo(PacketPtr pkt);     //gets the information of the packet and sends it to SystemC, stores and reads in memory depending on the command and region
 
+        void atomicPacketInfo(PacketPtr pkt);   //follows the mode changes of an atomic access, the NMC cores are not simulated in atomic mode
+
+        bool inNmcMode() const;     //true if any channel is in NMC mode, where the accesses to the banks are commands
+
         void copyhostAddr(uint8_t *hostAddrPart);       //gets the host Address from ramulator, to use it when doing WRs in memory via memcpy
 
         void copyRangeStart(uint64_t rngStrt);      //gets the Range of memory from ramulaor, to use it when doing WRs in memory via memcpy
 
+        void setWriteCallback(std::function<void(Addr, unsigned int)> cb);     //sets the function called after the CnM PUs write in exec region, e.g. to invalidate cached copies
+
         Addr returnAddr(PacketPtr pkt);     //gets the address of the packet
 
         uint8_t isRDCmd(PacketPtr pkt);        //returns true if the packet has a RD command, used to give this information to SystemC
@@ -62,6 +62,7 @@
 #include "base/flags.hh"
 #include "base/logging.hh"
 #include "base/printable.hh"
+#include "base/slab_pool.hh"
 #include "base/types.hh"
 #include "mem/request.hh"
 #include "sim/core.hh"
@@ -299,6 +300,8 @@ class Packet : public Printable
         /// the packet is destroyed. The pointer is assumed to be pointing
         /// to an array, and delete [] is consequently called
         DYNAMIC_DATA           = 0x00002000,
+        /// The dynamic data comes from the slab pools, see allocate()
+        POOLED_DATA            = 0x00004000,
 
         /// suppress the error if this packet encounters a functional
         /// access failure.
@@ -876,6 +879,27 @@ class Packet : public Printable
         deleteData();
     }
 
+    /**
+     * Packets are created and deleted at every memory access, so they
+     * come from the slab pool of the thread instead of the heap.
+     */
+    static void *
+    operator new(size_t size)
+    {
+        if (size != sizeof(Packet))
+            return ::operator new(size);
+        return SlabPool<sizeof(Packet)>::allocate();
+    }
+
+    static void
+    operator delete(void *p, size_t size)
+    {
+        if (size != sizeof(Packet))
+            ::operator delete(p);
+        else
+            SlabPool<sizeof(Packet)>::release(p);
+    }
+
     /**
      * Take a request packet and modify it in place to be suitable for
      * returning as a response to that request.
@@ -1126,10 +1150,12 @@ class Packet : public Printable
     void
     deleteData()
     {
-        if (flags.isSet(DYNAMIC_DATA))
+        if (flags.isSet(POOLED_DATA))
+            slabBufferRelease(data, getSize());
+        else if (flags.isSet(DYNAMIC_DATA))
             delete [] data;
 
-        flags.clear(STATIC_DATA|DYNAMIC_DATA);
+        flags.clear(STATIC_DATA|DYNAMIC_DATA|POOLED_DATA);
         data = NULL;
     }
 
@@ -1142,7 +1168,13 @@ class Packet : public Printable
         if (hasData() || hasRespData()) {
             assert(flags.noneSet(STATIC_DATA|DYNAMIC_DATA));
             flags.set(DYNAMIC_DATA);
-            data = new uint8_t[getSize()];
+            if (getSize() <= SlabBufferMax) {
+                // Cache lines and smaller, from the slab pools
+                flags.set(POOLED_DATA);
+                data = static_cast<uint8_t *>(slabBufferAllocate(getSize()));
+            } else {
+                data = new uint8_t[getSize()];
+            }
         }
     }
 
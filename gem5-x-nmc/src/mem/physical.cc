@@ -41,17 +41,23 @@
 
 #include <fcntl.h>
 #include <sys/mman.h>
+#include <sys/stat.h>
 #include <sys/types.h>
 #include <sys/user.h>
 #include <unistd.h>
 #include <zlib.h>
 
+#include <algorithm>
+#include <atomic>
 #include <cerrno>
 #include <climits>
 #include <cstdio>
+#include <cstring>
 #include <iostream>
 #include <string>
+#include <thread>
 
+#include "base/intmath.hh"
 #include "base/trace.hh"
 #include "debug/AddrRanges.hh"
 #include "debug/Checkpoint.hh"
@@ -71,10 +77,81 @@
 
 using namespace std;
 
+namespace {
+
+/**
+ * Sparse checkpoints of a store start with this header and the bitmap
+ * of the non-zero pages of the store. Then, for each chunk that has
+ * non-zero pages, comes the size of its compressed data (uint64_t) and
+ * the data, made of its non-zero pages in order.
+ */
+struct SparseStoreHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t pageSize;
+    uint64_t rangeSize;
+    uint64_t chunkSize;
+};
+
+const char sparseStoreMagic[8] = "gem5spm";
+const uint32_t sparseStoreVersion = 1;
+const uint64_t sparsePageSize = 4096;
+const uint64_t sparseChunkSize = 4 * 1024 * 1024;
+
+/**
+ * Run job(i) for every i in [begin, end) on up to num_threads threads,
+ * the calling one included.
+ */
+void
+parallelFor(uint64_t begin, uint64_t end, unsigned num_threads,
+            const function<void(uint64_t)>& job)
+{
+    atomic<uint64_t> next(begin);
+    auto worker = [&]() {
+        for (uint64_t i = next++; i < end; i = next++)
+            job(i);
+    };
+
+    vector<thread> threads;
+    for (uint64_t t = 1; t < num_threads && t < end - begin; ++t)
+        threads.emplace_back(worker);
+    worker();
+    for (auto& t : threads)
+        t.join();
+}
+
+const uint8_t zeroPage[sparsePageSize] = {};
+
+bool
+isZero(const uint8_t* data, uint64_t size)
+{
+    for (uint64_t i = 0; i < size; i += sparsePageSize) {
+        if (memcmp(data + i, zeroPage, min(sparsePageSize, size - i)))
+            return false;
+    }
+    return true;
+}
+
+inline bool
+pageSet(const vector<uint8_t>& bitmap, uint64_t page)
+{
+    return bitmap[page / 8] & (1 << (page % 8));
+}
+
+} // anonymous namespace
+
 PhysicalMemory::PhysicalMemory(const string& _name,
                                const vector<AbstractMemory*>& _memories,
-                               bool mmap_using_noreserve) :
-    _name(_name), size(0), mmapUsingNoReserve(mmap_using_noreserve)
+                               bool mmap_using_noreserve,
+                               bool sparse_checkpoints,
+                               unsigned checkpoint_threads,
+                               bool lazy_restore) :
+    _name(_name), size(0), mmapUsingNoReserve(mmap_using_noreserve),
+    sparseCheckpoints(sparse_checkpoints),
+    checkpointThreads(checkpoint_threads ? checkpoint_threads :
+                      max(thread::hardware_concurrency(), 1u)),
+    lazyRestore(lazy_restore)
 {
     if (mmap_using_noreserve)
         warn("Not reserving swap space. May cause SIGSEGV on actual usage\n");
@@ -330,7 +407,9 @@ PhysicalMemory::serializeStore(CheckpointOut &cp, unsigned int store_id,
 {
     // we cannot use the address range for the name as the
     // memories that are not part of the address map can overlap
-    string filename = name() + ".store" + to_string(store_id) + ".pmem";
+    string format = sparseCheckpoints ? "sparse" : "gzip";
+    string filename = name() + ".store" + to_string(store_id) +
+        (sparseCheckpoints ? ".spmem" : ".pmem");
     long range_size = range.size();
 
     DPRINTF(Checkpoint, "Serializing physical memory %s with size %d\n",
@@ -339,9 +418,15 @@ PhysicalMemory::serializeStore(CheckpointOut &cp, unsigned int store_id,
     SERIALIZE_SCALAR(store_id);
     SERIALIZE_SCALAR(filename);
     SERIALIZE_SCALAR(range_size);
+    SERIALIZE_SCALAR(format);
 
     // write memory file
     string filepath = CheckpointIn::dir() + "/" + filename.c_str();
+    if (sparseCheckpoints) {
+        serializeSparseStore(filepath, range_size, pmem);
+        return;
+    }
+
     gzFile compressed_mem = gzopen(filepath.c_str(), "wb");
     if (compressed_mem == NULL)
         fatal("Can't open physical memory checkpoint file '%s'\n",
@@ -370,6 +455,94 @@ PhysicalMemory::serializeStore(CheckpointOut &cp, unsigned int store_id,
 
 }
 
+void
+PhysicalMemory::serializeSparseStore(const string& filepath,
+                                     uint64_t range_size,
+                                     uint8_t* pmem) const
+{
+    FILE* f = fopen(filepath.c_str(), "wb");
+    if (f == NULL)
+        fatal("Can't open physical memory checkpoint file '%s'\n",
+              filepath);
+
+    const uint64_t num_pages = divCeil(range_size, sparsePageSize);
+    const uint64_t num_chunks = divCeil(range_size, sparseChunkSize);
+    const uint64_t pages_per_chunk = sparseChunkSize / sparsePageSize;
+
+    // find the non-zero pages, the bitmap bytes of a chunk are only
+    // written by the thread handling the chunk
+    vector<uint8_t> bitmap(divCeil(num_pages, 8), 0);
+    parallelFor(0, num_chunks, checkpointThreads, [&](uint64_t c) {
+        uint64_t end = min((c + 1) * pages_per_chunk, num_pages);
+        for (uint64_t p = c * pages_per_chunk; p < end; ++p) {
+            uint64_t offset = p * sparsePageSize;
+            if (!isZero(pmem + offset,
+                        min(sparsePageSize, range_size - offset)))
+                bitmap[p / 8] |= 1 << (p % 8);
+        }
+    });
+
+    SparseStoreHeader header;
+    memcpy(header.magic, sparseStoreMagic, sizeof(header.magic));
+    header.version = sparseStoreVersion;
+    header.pageSize = sparsePageSize;
+    header.rangeSize = range_size;
+    header.chunkSize = sparseChunkSize;
+    bool ok = fwrite(&header, sizeof(header), 1, f) == 1 &&
+        fwrite(bitmap.data(), 1, bitmap.size(), f) == bitmap.size();
+
+    // compress a batch of chunks in parallel and write it, so that
+    // only a batch of compressed chunks is held in memory
+    const uint64_t batch = 4 * checkpointThreads;
+    vector<vector<uint8_t>> compressed(batch);
+    atomic<bool> compress_ok(true);
+    for (uint64_t first = 0; ok && first < num_chunks; first += batch) {
+        uint64_t last = min(first + batch, num_chunks);
+        parallelFor(first, last, checkpointThreads, [&](uint64_t c) {
+            vector<uint8_t>& out = compressed[c - first];
+            out.clear();
+
+            vector<uint8_t> pages;
+            uint64_t end = min((c + 1) * pages_per_chunk, num_pages);
+            for (uint64_t p = c * pages_per_chunk; p < end; ++p) {
+                if (pageSet(bitmap, p)) {
+                    uint64_t offset = p * sparsePageSize;
+                    pages.insert(pages.end(), pmem + offset, pmem + offset +
+                                 min(sparsePageSize, range_size - offset));
+                }
+            }
+            if (pages.empty())
+                return;
+
+            uLongf out_size = compressBound(pages.size());
+            out.resize(out_size);
+            if (compress2(out.data(), &out_size, pages.data(), pages.size(),
+                          Z_BEST_SPEED) != Z_OK)
+                compress_ok = false;
+            out.resize(out_size);
+        });
+
+        for (uint64_t c = first; ok && c < last; ++c) {
+            const vector<uint8_t>& out = compressed[c - first];
+            if (out.empty())
+                continue;
+            uint64_t out_size = out.size();
+            ok = fwrite(&out_size, sizeof(out_size), 1, f) == 1 &&
+                fwrite(out.data(), 1, out_size, f) == out_size;
+        }
+    }
+
+    if (!compress_ok)
+        fatal("Compression failed on physical memory checkpoint file '%s'\n",
+              filepath);
+    if (!ok)
+        fatal("Write failed on physical memory checkpoint file '%s'\n",
+              filepath);
+    if (fclose(f))
+        fatal("Close failed on physical memory checkpoint file '%s'\n",
+              filepath);
+}
+
 void
 PhysicalMemory::unserialize(CheckpointIn &cp)
 {
@@ -398,8 +571,6 @@ PhysicalMemory::unserialize(CheckpointIn &cp)
 void
 PhysicalMemory::unserializeStore(CheckpointIn &cp)
 {
-    const uint32_t chunk_size = 16384;
-
     unsigned int store_id;
     UNSERIALIZE_SCALAR(store_id);
 
@@ -407,10 +578,12 @@ PhysicalMemory::unserializeStore(CheckpointIn &cp)
     UNSERIALIZE_SCALAR(filename);
     string filepath = cp.cptDir + "/" + filename;
 
-    // mmap memoryfile
-    gzFile compressed_mem = gzopen(filepath.c_str(), "rb");
-    if (compressed_mem == NULL)
-        fatal("Can't open physical memory checkpoint file '%s'", filename);
+    // checkpoints of older versions are always gzip
+    string format = "gzip";
+    optParamIn(cp, "format", format, false);
+    if (format != "gzip" && format != "sparse")
+        fatal("Unknown format '%s' of physical memory checkpoint file '%s'\n",
+              format, filename);
 
     // we've already got the actual backing store mapped
     uint8_t* pmem = backingStore[store_id].pmem;
@@ -426,24 +599,49 @@ PhysicalMemory::unserializeStore(CheckpointIn &cp)
         fatal("Memory range size has changed! Saw %lld, expected %lld\n",
               range_size, range.size());
 
+    auto read = [&](const StoreWriter& writer) {
+        if (format == "sparse")
+            readSparseStore(filepath, range_size, writer);
+        else
+            readGzipStore(filepath, range_size, writer);
+    };
+
+    if (lazyRestore && mapStoreImage(filepath, range_size, pmem, read))
+        return;
+
+    // Only copy what is non-zero, so we don't give the VM system hell
+    read([pmem](uint64_t offset, const uint8_t* data, uint64_t size) {
+        memcpy(pmem + offset, data, size);
+    });
+}
+
+void
+PhysicalMemory::readGzipStore(const string& filepath, uint64_t range_size,
+                              const StoreWriter& writer) const
+{
+    const uint32_t chunk_size = 16384;
+
+    // mmap memoryfile
+    gzFile compressed_mem = gzopen(filepath.c_str(), "rb");
+    if (compressed_mem == NULL)
+        fatal("Can't open physical memory checkpoint file '%s'", filepath);
+
     uint64_t curr_size = 0;
     long* temp_page = new long[chunk_size];
-    long* pmem_current;
     uint32_t bytes_read;
-    while (curr_size < range.size()) {
+    while (curr_size < range_size) {
         bytes_read = gzread(compressed_mem, temp_page, chunk_size);
         if (bytes_read == 0)
             break;
 
         assert(bytes_read % sizeof(long) == 0);
 
-        for (uint32_t x = 0; x < bytes_read / sizeof(long); x++) {
-            // Only copy bytes that are non-zero, so we don't give
-            // the VM system hell
-            if (*(temp_page + x) != 0) {
-                pmem_current = (long*)(pmem + curr_size + x * sizeof(long));
-                *pmem_current = *(temp_page + x);
-            }
+        // Only hand over the pages that are non-zero
+        const uint8_t* data = (const uint8_t*)temp_page;
+        for (uint32_t x = 0; x < bytes_read; x += sparsePageSize) {
+            uint64_t size = min<uint64_t>(sparsePageSize, bytes_read - x);
+            if (!isZero(data + x, size))
+                writer(curr_size + x, data + x, size);
         }
         curr_size += bytes_read;
     }
@@ -452,5 +650,173 @@ PhysicalMemory::unserializeStore(CheckpointIn &cp)
 
     if (gzclose(compressed_mem))
         fatal("Close failed on physical memory checkpoint file '%s'\n",
-              filename);
+              filepath);
+}
+
+void
+PhysicalMemory::readSparseStore(const string& filepath, uint64_t range_size,
+                                const StoreWriter& writer) const
+{
+    FILE* f = fopen(filepath.c_str(), "rb");
+    if (f == NULL)
+        fatal("Can't open physical memory checkpoint file '%s'\n",
+              filepath);
+
+    SparseStoreHeader header;
+    if (fread(&header, sizeof(header), 1, f) != 1 ||
+        memcmp(header.magic, sparseStoreMagic, sizeof(header.magic)))
+        fatal("Physical memory checkpoint file '%s' is not sparse\n",
+              filepath);
+    if (header.version != sparseStoreVersion)
+        fatal("Unsupported version %d of physical memory checkpoint "
+              "file '%s'\n", header.version, filepath);
+    if (header.rangeSize != range_size || !header.pageSize ||
+        header.chunkSize % header.pageSize)
+        fatal("Inconsistent header in physical memory checkpoint "
+              "file '%s'\n", filepath);
+
+    const uint64_t page_size = header.pageSize;
+    const uint64_t num_pages = divCeil(range_size, page_size);
+    const uint64_t num_chunks = divCeil(range_size, header.chunkSize);
+    const uint64_t pages_per_chunk = header.chunkSize / page_size;
+
+    vector<uint8_t> bitmap(divCeil(num_pages, 8));
+    if (fread(bitmap.data(), 1, bitmap.size(), f) != bitmap.size())
+        fatal("Read failed on physical memory checkpoint file '%s'\n",
+              filepath);
+
+    // read a batch of chunks and decompress it in parallel
+    const uint64_t batch = 4 * checkpointThreads;
+    vector<vector<uint8_t>> compressed(batch);
+    atomic<bool> ok(true);
+    for (uint64_t first = 0; first < num_chunks; first += batch) {
+        uint64_t last = min(first + batch, num_chunks);
+        for (uint64_t c = first; c < last; ++c) {
+            vector<uint8_t>& in = compressed[c - first];
+            in.clear();
+
+            uint64_t end = min((c + 1) * pages_per_chunk, num_pages);
+            bool has_data = false;
+            for (uint64_t p = c * pages_per_chunk; p < end; ++p)
+                has_data = has_data || pageSet(bitmap, p);
+            if (!has_data)
+                continue;
+
+            uint64_t in_size;
+            if (fread(&in_size, sizeof(in_size), 1, f) != 1 ||
+                in_size > compressBound(header.chunkSize))
+                fatal("Read failed on physical memory checkpoint file "
+                      "'%s'\n", filepath);
+            in.resize(in_size);
+            if (fread(in.data(), 1, in_size, f) != in_size)
+                fatal("Read failed on physical memory checkpoint file "
+                      "'%s'\n", filepath);
+        }
+
+        parallelFor(first, last, checkpointThreads, [&](uint64_t c) {
+            const vector<uint8_t>& in = compressed[c - first];
+            if (in.empty())
+                return;
+
+            uint64_t end = min((c + 1) * pages_per_chunk, num_pages);
+            uint64_t expected = 0;
+            for (uint64_t p = c * pages_per_chunk; p < end; ++p) {
+                if (pageSet(bitmap, p))
+                    expected += min(page_size, range_size - p * page_size);
+            }
+
+            vector<uint8_t> pages(expected);
+            uLongf pages_size = expected;
+            if (uncompress(pages.data(), &pages_size, in.data(),
+                           in.size()) != Z_OK || pages_size != expected) {
+                ok = false;
+                return;
+            }
+
+            // hand over each run of consecutive pages at once
+            const uint8_t* data = pages.data();
+            uint64_t p = c * pages_per_chunk;
+            while (p < end) {
+                if (!pageSet(bitmap, p)) {
+                    ++p;
+                    continue;
+                }
+                uint64_t offset = p * page_size;
+                while (p < end && pageSet(bitmap, p))
+                    ++p;
+                uint64_t size = min(p * page_size, range_size) - offset;
+                writer(offset, data, size);
+                data += size;
+            }
+        });
+
+        if (!ok)
+            fatal("Decompression failed on physical memory checkpoint "
+                  "file '%s'\n", filepath);
+    }
+
+    fclose(f);
+}
+
+bool
+PhysicalMemory::mapStoreImage(const string& filepath, uint64_t range_size,
+                              uint8_t* pmem,
+                              const function<void(const StoreWriter&)>& read)
+{
+    // the image is shared by all the restores of the checkpoint, it is
+    // created under a temporary name and renamed once complete, so
+    // concurrent simulations never map a partial image
+    string image = filepath + ".img";
+    struct stat cpt_stat, image_stat;
+    if (stat(filepath.c_str(), &cpt_stat) ||
+        stat(image.c_str(), &image_stat) ||
+        image_stat.st_size != (off_t)range_size ||
+        image_stat.st_mtime < cpt_stat.st_mtime) {
+        string tmp = image + ".tmp" + to_string(getpid());
+        int fd = open(tmp.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) {
+            warn("Can't create memory image '%s', restoring it eagerly\n",
+                 tmp);
+            return false;
+        }
+
+        // zero pages are left as holes of the file
+        atomic<bool> ok(ftruncate(fd, range_size) == 0);
+        if (ok) {
+            read([fd, &ok](uint64_t offset, const uint8_t* data,
+                           uint64_t size) {
+                if (pwrite(fd, data, size, offset) != (ssize_t)size)
+                    ok = false;
+            });
+        }
+        close(fd);
+
+        if (!ok || rename(tmp.c_str(), image.c_str())) {
+            unlink(tmp.c_str());
+            warn("Can't write memory image '%s', restoring it eagerly\n",
+                 image);
+            return false;
+        }
+    }
+
+    int fd = open(image.c_str(), O_RDONLY);
+    if (fd < 0) {
+        warn("Can't open memory image '%s', restoring it eagerly\n", image);
+        return false;
+    }
+
+    int map_flags = MAP_PRIVATE | MAP_FIXED;
+    if (mmapUsingNoReserve)
+        map_flags |= MAP_NORESERVE;
+
+    // replace the anonymous backing store, the simulation writes to
+    // private copies of the pages and never to the image
+    void* mapped = mmap(pmem, range_size, PROT_READ | PROT_WRITE, map_flags,
+                        fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED)
+        fatal("Could not mmap memory image '%s'\n", image);
+
+    DPRINTF(Checkpoint, "Mapped memory image %s\n", image);
+    return true;
 }
@@ -40,6 +40,8 @@
 #ifndef __MEM_PHYSICAL_HH__
 #define __MEM_PHYSICAL_HH__
 
+#include <functional>
+
 #include "base/addr_range_map.hh"
 #include "mem/packet.hh"
 
@@ -129,6 +131,16 @@ class PhysicalMemory : public Serializable
     // Let the user choose if we reserve swap space when calling mmap
     const bool mmapUsingNoReserve;
 
+    // Write checkpoints without the zero pages, compressed in parallel
+    const bool sparseCheckpoints;
+
+    // Threads compressing and decompressing the checkpoints
+    const unsigned checkpointThreads;
+
+    // Map an uncompressed image of the checkpoint copy-on-write
+    // instead of reading it all at restore
+    const bool lazyRestore;
+
     // The physical memory used to provide the memory in the simulated
     // system
     std::vector<BackingStoreEntry> backingStore;
@@ -153,6 +165,48 @@ class PhysicalMemory : public Serializable
                             bool conf_table_reported,
                             bool in_addr_map, bool kvm_map);
 
+    /**
+     * Consumer of the non-zero data of a checkpointed store, called
+     * with the offset in the store, the data and its size. It may be
+     * called from several threads at once, for different offsets.
+     */
+    typedef std::function<void(uint64_t, const uint8_t*, uint64_t)>
+        StoreWriter;
+
+    /**
+     * Write a store as a sparse checkpoint: a bitmap of the non-zero
+     * pages, followed by the non-zero pages of each chunk compressed
+     * with zlib, the chunks being compressed in parallel.
+     */
+    void serializeSparseStore(const std::string& filepath,
+                              uint64_t range_size, uint8_t* pmem) const;
+
+    /**
+     * Read a sparse checkpoint of a store, decompressing the chunks in
+     * parallel, and hand each run of its non-zero pages to the writer.
+     */
+    void readSparseStore(const std::string& filepath, uint64_t range_size,
+                         const StoreWriter& writer) const;
+
+    /**
+     * Read a gzip checkpoint of a store, as written by older versions,
+     * and hand its non-zero pages to the writer.
+     */
+    void readGzipStore(const std::string& filepath, uint64_t range_size,
+                       const StoreWriter& writer) const;
+
+    /**
+     * Map the uncompressed image of a checkpointed store over its
+     * backing store, copy-on-write, creating the image next to the
+     * checkpoint the first time. The pages are then read as the
+     * simulation touches them.
+     *
+     * @return false if the image could not be created or mapped
+     */
+    bool mapStoreImage(const std::string& filepath, uint64_t range_size,
+                       uint8_t* pmem,
+                       const std::function<void(const StoreWriter&)>& read);
+
   public:
 
     /**
@@ -160,7 +214,8 @@ class PhysicalMemory : public Serializable
      */
     PhysicalMemory(const std::string& _name,
                    const std::vector<AbstractMemory*>& _memories,
-                   bool mmap_using_noreserve);
+                   bool mmap_using_noreserve, bool sparse_checkpoints,
+                   unsigned checkpoint_threads, bool lazy_restore);
 
     /**
      * Unmap all the backing store we have used.
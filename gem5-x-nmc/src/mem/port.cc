@@ -206,7 +206,7 @@ MasterPort::sendRetryResp()
 void
 MasterPort::printAddr(Addr a)
 {
-    auto req = std::make_shared<Request>(
+    auto req = makeRequest(
         a, 1, 0, Request::funcMasterId);
 
     Packet pkt(req, MemCmd::PrintReq);
@@ -1,7 +1,9 @@
 #include "base/callback.hh"
+#include "base/output.hh"
 #include "mem/ramulator.hh"
 #include "Ramulator/src/Gem5Wrapper.h"
 #include "Ramulator/src/Request.h"
+#include "Ramulator/src/Statistics.h"
 #include "sim/system.hh"
 #include "debug/Ramulator.hh"
 #include "mem/packet.hh"
@@ -9,21 +11,38 @@
 Ramulator::Ramulator(const Params *p):
     AbstractMemory(p),
     port(name() + ".port", *this),
-    rd_requestsInFlight(0),
-    wr_requestsInFlight(0),
-    drain_manager(NULL),
+    master(name() + ".master", *this),
     config_file(p->config_file),
     configs(p->config_file),
     wrapper(NULL),
     nmc(p->nmc),
-    read_cb_func(std::bind(&Ramulator::readComplete, this, std::placeholders::_1)),
-    write_cb_func(std::bind(&Ramulator::writeComplete, this, std::placeholders::_1)),
+    // lambdas that only capture this fit in the small buffer of std::function,
+    // so copying the callback into every request does not allocate
+    read_cb_func([this](ramulator::Request& req) { readComplete(req); }),
+    write_cb_func([this](ramulator::Request& req) { writeComplete(req); }),
     ticks_per_clk(0),
     resp_stall(false),
     rd_req_stall(false),
     wr_req_stall(false),
+    rd_stall_channel(0),
+    wr_stall_channel(0),
+    host_profile(p->host_profile),
+    atomic_latency_model(p->atomic_latency_model),
+    ramulatorSeconds(0),
+    write_combining(p->write_combining),
+    wc_timeout(p->write_combining_timeout),
+    wc_valid(false),
+    wc_line(0),
+    wc_line_words(0),
+    wc_master(0),
+    wc_words(0),
+    nmc_master_id(0),
+    inv_retry(false),
+    trace_file(p->trace_file),
+    recorder(NULL),
     send_resp_event(this),
-    tick_event(this) 
+    tick_event(this),
+    wc_flush_event(this)
 {
     configs.set_core_num(p->num_cpus);
 }
@@ -32,6 +51,7 @@ Ramulator::~Ramulator()
 {
     delete wrapper;
     delete nmc;
+    delete recorder;
     std::cout << "Destructor ramulator" << std::endl;
 }
 
@@ -41,39 +61,84 @@ void Ramulator::init() {
     } else { 
         port.sendRangeChange(); 
     }
-    // if(!master.isConnected())
-    //     fatal("Ramulator master not connected\n");
+    // the Ramulator stats go under this object, as the rest of its stats
+    ramulator::stat_prefix() = name();
     wrapper = new ramulator::Gem5Wrapper(configs, system()->cacheLineSize());
     //nmc = new NMCcores();
     ticks_per_clk = Tick(wrapper->tCK * SimClock::Float::ns);
+    rd_requestsInFlight.assign(wrapper->num_channels(), 0);
+    wr_requestsInFlight.assign(wrapper->num_channels(), 0);
 
     DPRINTF(Ramulator, "Instantiated Ramulator with config file '%s' (tCK=%lf, %d ticks per clk)\n", 
         config_file.c_str(), wrapper->tCK, ticks_per_clk);
+    // the averages are derived from the counters before every dump, so that
+    // they follow m5_reset_stats and m5_dump_reset_stats as the counters do
     Callback* cb = new MakeCallback<ramulator::Gem5Wrapper, &ramulator::Gem5Wrapper::finish>(wrapper);
-    registerExitCallback(cb);
+    Stats::registerDumpCallback(cb);
+    if (host_profile)
+        registerExitCallback(new MakeCallback<Ramulator, &Ramulator::reportHostProfile>(this));
+
+    // the destructor is not called at exit, the callback flushes the trace
+    if (trace_file != "") {
+        recorder = new NMCTraceRecorder(simout.resolve(trace_file), name(), getAddrRange());
+        registerExitCallback(new MakeCallback<Ramulator, &Ramulator::closeTrace>(this));
+    }
 
     nmc->copyhostAddr(pmemAddr);
     nmc->copyRangeStart((getAddrRange()).start());
+    // without the master port the results are only coherent for uncached reads
+    if (master.isConnected()) {
+        nmc_master_id = system()->getMasterId(this, "nmc");
+        nmc->setWriteCallback([this](Addr addr, unsigned int size) { invalidateLines(addr, size); });
+    }
 }
 
 void Ramulator::startup() {
     schedule(tick_event, clockEdge());
 }
 
+void Ramulator::regStats() {
+    AbstractMemory::regStats();
+
+    wcStores
+        .name(name() + ".wc_stores")
+        .desc("Stores merged by the write-combining buffer")
+        ;
+    wcWrites
+        .name(name() + ".wc_writes")
+        .desc("Writes sent to Ramulator by the write-combining buffer")
+        ;
+    nmcInvalidations
+        .name(name() + ".nmc_invalidations")
+        .desc("Cache lines invalidated after the writes of the NMC cores")
+        ;
+}
+
 //unsigned int Ramulator::drain(DrainManager* dm) {
 DrainState Ramulator::drain()
 {
     DPRINTF(Ramulator, "Requested to drain\n");
+    // a line that Ramulator does not take yet is retried on the next clock,
+    // rather than at the timeout
+    if (wc_valid && !wcFlush())
+        reschedule(wc_flush_event, curTick() + ticks_per_clk, true);
     // updated to include all in-flight requests
     // if (resp_queue.size()) {
     if (numOutstanding()) {
-        //drain_manager = dm;
         return DrainState::Draining;
     } else {
         return DrainState::Drained;
     }
 }
 
+void Ramulator::checkDrainDone()
+{
+    if (drainState() == DrainState::Draining && numOutstanding() == 0) {
+        DPRINTF(Ramulator, "Done draining\n");
+        signalDrainDone();
+    }
+}
+
 BaseSlavePort& Ramulator::getSlavePort(const std::string& if_name, PortID idx) {
     if (if_name != "port") {
         return MemObject::getSlavePort(if_name, idx);
@@ -82,6 +147,14 @@ BaseSlavePort& Ramulator::getSlavePort(const std::string& if_name, PortID idx) {
     }
 }
 
+BaseMasterPort& Ramulator::getMasterPort(const std::string& if_name, PortID idx) {
+    if (if_name != "master") {
+        return MemObject::getMasterPort(if_name, idx);
+    } else {
+        return master;
+    }
+}
+
 void Ramulator::sendResponse() {
     assert(!resp_stall);
     assert(!resp_queue.empty());
@@ -91,38 +164,64 @@ void Ramulator::sendResponse() {
     long addr = resp_queue.front()->getAddr();
     if (port.sendTimingResp(resp_queue.front())){
         DPRINTF(Ramulator, "Response to %ld sent.\n", addr);
+        if (recorder)
+            recorder->response(resp_queue.front());
         resp_queue.pop_front();
         if (resp_queue.size() && !send_resp_event.scheduled())
             schedule(send_resp_event, curTick());
 
-        // check if we were asked to drain and if we are now done
-        if (drain_manager && numOutstanding() == 0) {
-            drain_manager->signalDrainDone();
-            drain_manager = NULL;
-        }
+        checkDrainDone();
     } else 
         resp_stall = true;
 }
     
 void Ramulator::tick() {
-    wrapper->tick();
-    if (rd_req_stall && rd_requestsInFlight < wrapper->rdqueuesize()){
+    if (host_profile) {
+        auto start = std::chrono::steady_clock::now();
+        wrapper->tick();
+        ramulatorSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    } else {
+        wrapper->tick();
+    }
+    // only the channel that refused the request has to make room for it
+    if (rd_req_stall && rd_requestsInFlight[rd_stall_channel] < wrapper->rdqueuesize(rd_stall_channel)){
         rd_req_stall = false;
         port.sendRetryReq();
     }
-    if (wr_req_stall && wr_requestsInFlight < wrapper->wrqueuesize()){
+    if (wr_req_stall && wr_requestsInFlight[wr_stall_channel] < wrapper->wrqueuesize(wr_stall_channel)){
         wr_req_stall = false;
         port.sendRetryReq();
     }
     schedule(tick_event, curTick() + ticks_per_clk);
 }
 
+void Ramulator::closeTrace() {
+    delete recorder;
+    recorder = NULL;
+}
+
+void Ramulator::reportHostProfile() {
+    std::cout << "Ramulator host seconds: " << ramulatorSeconds << std::endl;
+}
+
 // added an atomic packet response function to enable fast forwarding
 Tick Ramulator::recvAtomic(PacketPtr pkt) {
+    bool need_resp = pkt->needsResponse();
     access(pkt);
-
-    // set an fixed arbitrary 50ns response time for atomic requests
-    return pkt->cacheResponding() ? 0 : 50000;
+    // the controllers and the NMC cores only follow the mode changes, so that
+    // they are in the right mode when switching to timing, e.g. to simulate
+    // the NMC regions in detail
+    if (need_resp && wrapper->atomic_mode_change(pkt->getAddr()))
+        nmc->atomicPacketInfo(pkt);
+
+    if (pkt->cacheResponding())
+        return 0;
+    if (!atomic_latency_model)
+        return 50000;
+
+    // analytic latency from the open rows of Ramulator, see atomic_latency
+    long clk = curTick() / ticks_per_clk;
+    return wrapper->atomic_latency(pkt->getAddr(), pkt->isWrite(), clk) * ticks_per_clk;
 }
 
 void Ramulator::recvFunctional(PacketPtr pkt) {
@@ -134,6 +233,20 @@ void Ramulator::recvFunctional(PacketPtr pkt) {
 }
 
 bool Ramulator::recvTimingReq(PacketPtr pkt) {
+    if (!recorder)
+        return handleTimingReq(pkt);
+
+    // captured before the packet is turned into a response, and written
+    // once accepted, so a retried request is recorded once
+    NMCTraceRecord record;
+    bool traced = recorder->capture(pkt, record);
+    bool accepted = handleTimingReq(pkt);
+    if (accepted && traced)
+        recorder->request(pkt, record);
+    return accepted;
+}
+
+bool Ramulator::handleTimingReq(PacketPtr pkt) {
     // we should never see a new request while in retry
 
     for (PacketPtr pendPkt: pending_del)
@@ -147,21 +260,43 @@ bool Ramulator::recvTimingReq(PacketPtr pkt) {
         return true;
     }
 
+    if (write_combining) {
+        if (unsigned int line_words = wcLineWords(pkt)) {
+            // a store to another line pushes out the one being combined
+            Addr line = pkt->getAddr() & ~Addr(line_words * (DQ_BITS / 8) - 1);
+            if (wc_valid && line != wc_line && !wcFlush()) {
+                wr_req_stall = true;
+                wr_stall_channel = wrapper->channel(wc_line);
+                return false;
+            }
+            wcMerge(pkt, line_words);
+            return true;
+        }
+        // the rest of the requests are ordered after the combined stores
+        if (wc_valid && !wcFlush()) {
+            wr_req_stall = true;
+            wr_stall_channel = wrapper->channel(wc_line);
+            return false;
+        }
+    }
+
     bool accepted = true;
     if (pkt->isRead()) {
         assert(!rd_req_stall);
         DPRINTF(Ramulator, "context id: %d\n", pkt->req->contextId());
         ramulator::Request req(pkt->getAddr(), ramulator::Request::Type::READ, read_cb_func, pkt->req->contextId());
         accepted = wrapper->send(req);
+        int channel = req.addr_vec[0];
         if (accepted){
 
             reads[req.addr].push_back(pkt);
-            DPRINTF(Ramulator, "Read to %ld accepted.\n", req.addr);
+            DPRINTF(Ramulator, "Read to %ld accepted by channel %d.\n", req.addr, channel);
 
             // added counter to track requests in flight
-            ++rd_requestsInFlight;
+            ++rd_requestsInFlight[channel];
         } else {
             rd_req_stall = true;
+            rd_stall_channel = channel;
         }
     } else if (pkt->isWrite()) {
         assert(!wr_req_stall);
@@ -170,15 +305,17 @@ bool Ramulator::recvTimingReq(PacketPtr pkt) {
         // tallied for any core/thread
         ramulator::Request req(pkt->getAddr(), ramulator::Request::Type::WRITE, write_cb_func, 0);
         accepted = wrapper->send(req);
+        int channel = req.addr_vec[0];
         if (accepted){
 
             accessAndRespond(pkt);
-            DPRINTF(Ramulator, "Write to %ld accepted and served.\n", req.addr);
+            DPRINTF(Ramulator, "Write to %ld accepted by channel %d and served.\n", req.addr, channel);
 
             // added counter to track requests in flight
-            ++wr_requestsInFlight;
+            ++wr_requestsInFlight[channel];
         } else {
             wr_req_stall = true;
+            wr_stall_channel = channel;
         }
     } else {
         // keep it simple and just respond if necessary
@@ -187,6 +324,123 @@ bool Ramulator::recvTimingReq(PacketPtr pkt) {
     return accepted;
 }
 
+unsigned int Ramulator::wcLineWords(PacketPtr pkt) const {
+    Addr addr = pkt->getAddr();
+    if (!pkt->isWrite() || addr % (DQ_BITS / 8) || pkt->getSize() % (DQ_BITS / 8))
+        return 0;
+
+    // The GRF lines, that NMCcores takes whole. The stores to the banks are
+    // commands in NMC mode, and only data for the kernels in host mode, e.g.
+    // the memcpy of the inputs and weights by storeKernel
+    unsigned int line_words;
+    if (addr >= GRFA_START && addr < GRFB_END)
+        line_words = DQ_CLK;
+    else if (addr >= EXEC_START && addr < EXEC_END && !nmc->inNmcMode())
+        line_words = wc_max_words;
+    else
+        return 0;
+
+    const unsigned int line_bytes = line_words * (DQ_BITS / 8);
+    return addr % line_bytes + pkt->getSize() <= line_bytes ? line_words : 0;
+}
+
+void Ramulator::wcMerge(PacketPtr pkt, unsigned int line_words) {
+    Addr line = pkt->getAddr() & ~Addr(line_words * (DQ_BITS / 8) - 1);
+    if (!wc_valid) {
+        wc_valid = true;
+        wc_line = line;
+        wc_line_words = line_words;
+        wc_master = pkt->req->masterId();
+        wc_words = 0;
+        schedule(wc_flush_event, curTick() + wc_timeout);
+    }
+
+    unsigned int first = (pkt->getAddr() - line) / (DQ_BITS / 8);
+    unsigned int words = pkt->getSize() / (DQ_BITS / 8);
+    memcpy(&wc_data[first], pkt->getConstPtr<uint8_t>(), pkt->getSize());
+    wc_words |= ((1U << words) - 1) << first;
+    ++wcStores;
+    DPRINTF(Ramulator, "Store to %#x combined in line %#x\n", pkt->getAddr(), wc_line);
+
+    // the data is already in the memory, only the DRAM write and NMCcores wait
+    accessAndRespond(pkt, false);
+
+    if (wc_words == (1U << wc_line_words) - 1 && !wcFlush())
+        reschedule(wc_flush_event, curTick() + ticks_per_clk, true);
+}
+
+bool Ramulator::wcFlush() {
+    ramulator::Request req(wc_line, ramulator::Request::Type::WRITE, write_cb_func, 0);
+    bool accepted = wrapper->send(req);
+    int channel = req.addr_vec[0];
+    if (!accepted) {
+        DPRINTF(Ramulator, "Combined write to line %#x refused by channel %d\n", wc_line, channel);
+        return false;
+    }
+    ++wr_requestsInFlight[channel];
+    ++wcWrites;
+    wc_valid = false;
+    if (wc_flush_event.scheduled())
+        deschedule(wc_flush_event);
+    DPRINTF(Ramulator, "Combined write to line %#x sent to channel %d\n", wc_line, channel);
+
+    // NMCcores sees a complete GRF line as one write, and the words of the
+    // other lines as the stores they came from
+    if (wc_line_words == DQ_CLK && wc_words == (1U << DQ_CLK) - 1) {
+        RequestPtr line_req = makeRequest(wc_line, GRF_WIDTH / 8, 0, wc_master);
+        Packet line_pkt(line_req, MemCmd::WriteReq);
+        line_pkt.dataStatic(wc_data);
+        nmc->packetInfo(&line_pkt);
+    } else {
+        for (unsigned int i = 0; i < wc_line_words; i++) {
+            if (!(wc_words & (1U << i)))
+                continue;
+            RequestPtr word_req = makeRequest(wc_line + i * (DQ_BITS / 8), DQ_BITS / 8, 0, wc_master);
+            Packet word_pkt(word_req, MemCmd::WriteReq);
+            word_pkt.dataStatic(&wc_data[i]);
+            nmc->packetInfo(&word_pkt);
+        }
+    }
+    return true;
+}
+
+void Ramulator::wcTimeout() {
+    if (wc_valid && !wcFlush())
+        schedule(wc_flush_event, curTick() + ticks_per_clk);
+}
+
+void Ramulator::invalidateLines(Addr addr, unsigned int size) {
+    Addr line_size = system()->cacheLineSize();
+    for (Addr line = addr & ~(line_size - 1); line < addr + size; line += line_size) {
+        RequestPtr req = makeRequest(line, line_size, 0, nmc_master_id);
+        PacketPtr pkt = new Packet(req, MemCmd::InvalidateReq);
+        if (system()->isTimingMode()) {
+            inv_queue.push_back(pkt);
+        } else {
+            master.sendAtomic(pkt);
+            delete pkt;
+            ++nmcInvalidations;
+        }
+    }
+    if (!inv_retry)
+        sendInvalidations();
+}
+
+void Ramulator::sendInvalidations() {
+    inv_retry = false;
+    while (!inv_queue.empty()) {
+        if (!master.sendTimingReq(inv_queue.front())) {
+            inv_retry = true;
+            return;
+        }
+        DPRINTF(Ramulator, "Invalidation of line %#x sent\n", inv_queue.front()->getAddr());
+        inv_queue.pop_front();
+        ++nmcInvalidations;
+    }
+
+    checkDrainDone();
+}
+
 void Ramulator::recvRetry() {
     DPRINTF(Ramulator, "Retrying\n");
 
@@ -195,7 +449,7 @@ void Ramulator::recvRetry() {
     sendResponse();
 }
 
-void Ramulator::accessAndRespond(PacketPtr pkt) {
+void Ramulator::accessAndRespond(PacketPtr pkt, bool nmc_info) {
 
     bool need_resp = pkt->needsResponse();
     access(pkt);
@@ -203,7 +457,8 @@ void Ramulator::accessAndRespond(PacketPtr pkt) {
         assert(pkt->isResponse());
         pkt->headerDelay = pkt->payloadDelay = 0;
 
-        nmc->packetInfo(pkt);
+        if (nmc_info)
+            nmc->packetInfo(pkt);
         //nmc->giveInfo(pkt);
     
         DPRINTF(Ramulator, "Queuing response for address %lld\n",
@@ -224,8 +479,9 @@ void Ramulator::readComplete(ramulator::Request& req){
     if (!pkt_q.size())
         reads.erase(req.addr);
 
-    // added counter to track requests in flight
-    --rd_requestsInFlight;
+    // added counter to track requests in flight, the channel is the first
+    // level of the address vector filled by Ramulator
+    --rd_requestsInFlight[req.addr_vec[0]];
 
     accessAndRespond(pkt);
 }
@@ -234,13 +490,9 @@ void Ramulator::writeComplete(ramulator::Request& req){
     DPRINTF(Ramulator, "Write to %ld completed.\n", req.addr);
 
     // added counter to track requests in flight
-    --wr_requestsInFlight;
+    --wr_requestsInFlight[req.addr_vec[0]];
 
-    // check if we were asked to drain and if we are now done
-    if (drain_manager && numOutstanding() == 0) {
-        drain_manager->signalDrainDone();
-        drain_manager = NULL;
-    }
+    checkDrainDone();
 }
 
 Ramulator *RamulatorParams::create(){
@@ -4,12 +4,16 @@
 #include <deque>
 #include <tuple>
 #include <map>
+#include <vector>
+#include <chrono>
 
 #include "mem/abstract_mem.hh"
 #include "params/Ramulator.hh"
 #include "Ramulator/src/Config.h"
 #include "mem/port.hh"
 #include "mem/nmccores.hh"
+#include "mem/nmc_trace.hh"
+#include "base/statistics.hh"
 
 namespace ramulator{
     class Request;
@@ -49,14 +53,33 @@ private:
             return ranges;
         }
     } port;
+
+    // Port to the system crossbar, where the lines written by the NMC cores
+    // are invalidated in the caches so the host can read the results cached
+    class NMCMasterPort: public MasterPort {
+    private:
+        Ramulator& mem;
+    public:
+        NMCMasterPort(const std::string& _name, Ramulator& _mem): MasterPort(_name, &_mem), mem(_mem) {}
+    protected:
+        bool recvTimingResp(PacketPtr pkt) {
+            delete pkt;
+            return true;
+        }
+
+        void recvReqRetry() {
+            mem.sendInvalidations();
+        }
+    } master;
     
-    unsigned int rd_requestsInFlight;
-    unsigned int wr_requestsInFlight;
+    // requests in flight per channel, so that a full channel does not hold
+    // back the requests to the others
+    std::vector<unsigned int> rd_requestsInFlight;
+    std::vector<unsigned int> wr_requestsInFlight;
     std::map<long, std::deque<PacketPtr> > reads;
     std::map<long, std::deque<PacketPtr> > writes;
     std::deque<PacketPtr> resp_queue;
     std::deque<PacketPtr> pending_del;
-    DrainManager *drain_manager;
 
     std::string config_file;
     ramulator::Config configs;
@@ -68,33 +91,89 @@ private:
     bool resp_stall;
     bool rd_req_stall;
     bool wr_req_stall;
+    int rd_stall_channel;
+    int wr_stall_channel;
+    bool host_profile;
+    bool atomic_latency_model;
+    double ramulatorSeconds;
 
-    unsigned int numOutstanding() const { return rd_requestsInFlight + wr_requestsInFlight + resp_queue.size(); }
+    // Write combining of the host stores to the GRFs, and in host mode to the
+    // banks. The stores to a GRF line or to a burst of the banks are served as
+    // they arrive, and the line goes to Ramulator and NMCcores as a single
+    // write when it is complete, when any other request arrives or after
+    // wc_timeout. NMClib maps the NMC memory as Device memory (O_SYNC), so
+    // the stores arrive one by one and in order; combining them here rather
+    // than in the CPU keeps that order for the NMC commands.
+    static const unsigned int wc_max_words = (1 << GLOBAL_OFFSET) / (DQ_BITS / 8);
+    bool write_combining;
+    Tick wc_timeout;
+    bool wc_valid;
+    Addr wc_line;                   // address of the line being combined
+    unsigned int wc_line_words;     // DQ words of the line, DQ_CLK for a GRF line
+    MasterID wc_master;
+    uint64_t wc_data[wc_max_words];
+    unsigned int wc_words;          // mask of the DQ words of the line already written
+
+    unsigned int wcLineWords(PacketPtr pkt) const;  // 0 if the store is not combined
+    void wcMerge(PacketPtr pkt, unsigned int line_words);
+    bool wcFlush();                 // false if Ramulator could not take the write yet
+    void wcTimeout();
+
+    // Invalidations of the lines written by the NMC cores, sent through master
+    MasterID nmc_master_id;
+    std::deque<PacketPtr> inv_queue;
+    bool inv_retry;
+
+    void invalidateLines(Addr addr, unsigned int size);
+    void sendInvalidations();
+
+    // Trace of the requests and their dependencies on the responses, to
+    // replay them with the NMCTracePlayer
+    std::string trace_file;
+    NMCTraceRecorder *recorder;
+
+    Stats::Scalar wcStores;
+    Stats::Scalar wcWrites;
+    Stats::Scalar nmcInvalidations;
+
+    unsigned int numOutstanding() const {
+        unsigned int outstanding = resp_queue.size() + wc_valid + inv_queue.size();
+        for (unsigned int ch = 0; ch < rd_requestsInFlight.size(); ch++)
+            outstanding += rd_requestsInFlight[ch] + wr_requestsInFlight[ch];
+        return outstanding;
+    }
     
+    // signals the end of a drain when nothing is left in flight
+    void checkDrainDone();
     void sendResponse();
     void tick();
+    void reportHostProfile();
+    void closeTrace();
     
     EventWrapper<Ramulator, &Ramulator::sendResponse> send_resp_event;
     EventWrapper<Ramulator, &Ramulator::tick> tick_event;
+    EventWrapper<Ramulator, &Ramulator::wcTimeout> wc_flush_event;
 
 public:
     typedef RamulatorParams Params;
     Ramulator(const Params *p);
     virtual void init();
     virtual void startup();
+    void regStats() override;
     //unsigned int drain(DrainManager* dm);
     DrainState drain() override;
     virtual BaseSlavePort& getSlavePort(const std::string& if_name, 
         PortID idx = InvalidPortID);
-    // virtual BaseMasterPort& getMasterPort(const std::string& if_name, 
-    //     PortID idx = InvalidPortID);
+    virtual BaseMasterPort& getMasterPort(const std::string& if_name, 
+        PortID idx = InvalidPortID);
     ~Ramulator();
 protected:
     Tick recvAtomic(PacketPtr pkt);
     void recvFunctional(PacketPtr pkt);
     bool recvTimingReq(PacketPtr pkt);
+    bool handleTimingReq(PacketPtr pkt);
     void recvRetry();
-    void accessAndRespond(PacketPtr pkt);
+    void accessAndRespond(PacketPtr pkt, bool nmc_info = true);
     void readComplete(ramulator::Request& req);
     void writeComplete(ramulator::Request& req);
 };
@@ -54,9 +54,12 @@
 
 #include <cassert>
 #include <climits>
+#include <memory>
+#include <utility>
 
 #include "base/flags.hh"
 #include "base/logging.hh"
+#include "base/slab_pool.hh"
 #include "base/types.hh"
 #include "cpu/inst_seq.hh"
 #include "sim/core.hh"
@@ -84,6 +87,14 @@ class Request;
 typedef std::shared_ptr<Request> RequestPtr;
 typedef uint16_t MasterID;
 
+/**
+ * Create a request shared through a RequestPtr, with the arguments of a
+ * Request constructor. As for packets, the requests and their reference
+ * counts come from the slab pool of the thread instead of the heap.
+ */
+template <typename... Args>
+RequestPtr makeRequest(Args&&... args);
+
 class Request
 {
   public:
@@ -534,8 +545,8 @@ class Request
         assert(privateFlags.isSet(VALID_VADDR));
         assert(privateFlags.noneSet(VALID_PADDR));
         assert(split_addr > _vaddr && split_addr < _vaddr + _size);
-        req1 = std::make_shared<Request>(*this);
-        req2 = std::make_shared<Request>(*this);
+        req1 = makeRequest(*this);
+        req2 = makeRequest(*this);
         req1->_size = split_addr - _vaddr;
         req2->_vaddr = split_addr;
         req2->_size = _size - req1->_size;
@@ -936,4 +947,12 @@ class Request
     /** @} */
 };
 
+template <typename... Args>
+RequestPtr
+makeRequest(Args&&... args)
+{
+    return std::allocate_shared<Request>(SlabAllocator<Request>(),
+                                         std::forward<Args>(args)...);
+}
+
 #endif // __MEM_REQUEST_HH__
@@ -115,11 +115,26 @@ def _textFactory(fn, desc=True):
 
     return _m5.stats.initText(fn, desc)
 
+@_url_factory
+def _binaryFactory(fn):
+    """Output stats in binary format.
+
+    Binary stat files contain the names of the stats once, and the
+    values that changed at each dump, which makes frequent dumps much
+    cheaper than in text. They are read with util/binary_stats.py.
+
+    Example: binary://stats.bin
+
+    """
+
+    return _m5.stats.initBinary(fn)
+
 factories = {
     # Default to the text factory if we're given a naked path
     "" : _textFactory,
     "file" : _textFactory,
     "text" : _textFactory,
+    "binary" : _binaryFactory,
 }
 
 def addStatVisitor(url):
@@ -202,14 +217,7 @@ def dump():
 
     _m5.stats.processDumpQueue()
 
-    prepare()
-
-    for output in outputList:
-        if output.valid():
-            output.begin()
-            for stat in stats_list:
-                stat.visit(output)
-            output.end()
+    _m5.stats.dumpStats(stats_list, outputList)
 
 def reset():
     '''Reset all statistics to the base state'''
@@ -45,6 +45,7 @@
 #include "pybind11/stl.h"
 
 #include "base/statistics.hh"
+#include "base/stats/binary.hh"
 #include "base/stats/text.hh"
 #include "sim/stat_control.hh"
 #include "sim/stat_register.hh"
@@ -60,6 +61,28 @@ pythonDump()
     m.attr("dump")();
 }
 
+/**
+ * Prepare the stats and visit them with the valid outputs, in the order
+ * of the list, without a call from Python for each stat.
+ */
+void
+pythonDumpStats(const std::vector<Info *> &stats,
+                const std::vector<Output *> &outputs)
+{
+    for (auto stat : stats)
+        stat->prepare();
+
+    for (auto output : outputs) {
+        if (!output->valid())
+            continue;
+
+        output->begin();
+        for (auto stat : stats)
+            stat->visit(*output);
+        output->end();
+    }
+}
+
 void
 pythonReset()
 {
@@ -77,6 +100,9 @@ pybind_init_stats(py::module &m_native)
     m
         .def("initSimStats", &Stats::initSimStats)
         .def("initText", &Stats::initText, py::return_value_policy::reference)
+        .def("initBinary", &Stats::initBinary,
+             py::return_value_policy::reference)
+        .def("dumpStats", &Stats::pythonDumpStats)
         .def("registerPythonStatsHandlers",
              &Stats::registerPythonStatsHandlers)
         .def("schedStatEvent", &Stats::schedStatEvent)
@@ -75,6 +75,15 @@ class System(MemObject):
     # (but sparse) memory is simulated.
     mmap_using_noreserve = Param.Bool(False, "mmap the backing store " \
                                           "without reserving swap")
+    checkpoint_sparse = Param.Bool(True, "Checkpoint the backing store " \
+                                       "as compressed non-zero pages, " \
+                                       "instead of a single gzip stream")
+    checkpoint_threads = Param.Unsigned(0, "Threads compressing the " \
+                                        "backing store, 0 for one per " \
+                                        "host core")
+    lazy_restore = Param.Bool(False, "Restore the backing store by " \
+                              "mapping an image of the checkpoint, " \
+                              "loading the pages on first access")
 
     # The memory ranges are to be populated when creating the system
     # such that these can be passed from the I/O subsystem through an
@@ -32,12 +32,14 @@
  *          Steve Raasch
  */
 
+#include <algorithm>
 #include <cassert>
 #include <iostream>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
+#include "base/intmath.hh"
 #include "base/logging.hh"
 #include "base/trace.hh"
 #include "cpu/smt.hh"
@@ -114,29 +116,6 @@ Event::insertBefore(Event *event, Event *curr)
     return event;
 }
 
-void
-EventQueue::insert(Event *event)
-{
-    // Deal with the head case
-    if (!head || *event <= *head) {
-        head = Event::insertBefore(event, head);
-        return;
-    }
-
-    // Figure out either which 'in bin' list we are on, or where a new list
-    // needs to be inserted
-    Event *prev = head;
-    Event *curr = head->nextBin;
-    while (curr && *curr < *event) {
-        prev = curr;
-        curr = curr->nextBin;
-    }
-
-    // Note: this operation may render all nextBin pointers on the
-    // prev 'in bin' list stale (except for the top one)
-    prev->nextBin = Event::insertBefore(event, curr);
-}
-
 Event *
 Event::removeItem(Event *event, Event *top)
 {
@@ -168,6 +147,182 @@ Event::removeItem(Event *event, Event *top)
     return top;
 }
 
+#if USE_CALENDAR_EVENTQ
+
+void
+EventQueue::insert(Event *event)
+{
+    // Find the bin of the event in its bucket, or where a new bin goes
+    Event **bin = &buckets[bucketIndex(event->when())];
+    while (*bin && **bin < *event)
+        bin = &(*bin)->nextBin;
+    *bin = Event::insertBefore(event, *bin);
+
+    if (!head || *event <= *head)
+        head = event;
+
+    if (++numEvents > 2 * buckets.size())
+        resize(2 * buckets.size());
+}
+
+void
+EventQueue::insertBin(Event *bin)
+{
+    Event **curr = &buckets[bucketIndex(bin->when())];
+    while (*curr && **curr < *bin)
+        curr = &(*curr)->nextBin;
+    bin->nextBin = *curr;
+    *curr = bin;
+}
+
+Event *
+EventQueue::findHead(Tick from) const
+{
+    if (!numEvents)
+        return NULL;
+
+    // The earliest bin is the first one of its bucket. Look for it
+    // bucket after bucket during one turn of the calendar...
+    const Tick window = from >> bucketShift;
+    for (size_t i = 0; i < buckets.size(); ++i) {
+        Event *bin = buckets[(window + i) & (buckets.size() - 1)];
+        if (bin && (bin->when() >> bucketShift) == window + i)
+            return bin;
+    }
+
+    // ...and if all the events are further away, among all the buckets
+    Event *earliest = NULL;
+    for (Event *bin : buckets) {
+        if (bin && (!earliest || *bin < *earliest))
+            earliest = bin;
+    }
+    return earliest;
+}
+
+void
+EventQueue::remove(Event *event)
+{
+    if (head == NULL)
+        panic("event not found!");
+
+    assert(event->queue == this);
+
+    // Find the 'in bin' list that this event belongs on
+    Event **bin = &buckets[bucketIndex(event->when())];
+    while (*bin && **bin < *event)
+        bin = &(*bin)->nextBin;
+
+    if (!*bin || **bin != *event)
+        panic("event not found!");
+
+    *bin = Event::removeItem(event, *bin);
+    --numEvents;
+
+    // If the earliest bin is left empty, the next one can be anywhere
+    if (event == head)
+        head = (*bin && **bin == *event) ? *bin : findHead(event->when());
+
+    if (numEvents < buckets.size() / 4 && buckets.size() > MinBuckets)
+        resize(buckets.size() / 2);
+}
+
+void
+EventQueue::removeHead()
+{
+    Event *event = head;
+    Event *next = head->nextInBin;
+    Event *&bin = buckets[bucketIndex(event->when())];
+    assert(bin == head);
+    --numEvents;
+
+    if (next) {
+        // update the next bin pointer since it could be stale
+        next->nextBin = head->nextBin;
+
+        // pop the stack
+        bin = next;
+        head = next;
+    } else {
+        bin = head->nextBin;
+        head = findHead(event->when());
+    }
+
+    if (numEvents < buckets.size() / 4 && buckets.size() > MinBuckets)
+        resize(buckets.size() / 2);
+}
+
+void
+EventQueue::resize(size_t num_buckets)
+{
+    std::vector<Event *> bins;
+    for (Event *bin : buckets) {
+        for (; bin; bin = bin->nextBin)
+            bins.push_back(bin);
+    }
+
+    // Make a bucket about three times the average spacing of the
+    // earliest bins, leaving out the gaps over twice the average
+    const size_t samples = std::min<size_t>(bins.size(), 25);
+    if (samples > 1) {
+        std::partial_sort(bins.begin(), bins.begin() + samples, bins.end(),
+                          [](Event *l, Event *r) { return *l < *r; });
+        Tick span = bins[samples - 1]->when() - bins[0]->when();
+        Tick gaps = 0;
+        size_t num_gaps = 0;
+        for (size_t i = 1; i < samples; ++i) {
+            Tick gap = bins[i]->when() - bins[i - 1]->when();
+            if (gap * (samples - 1) <= 2 * span) {
+                gaps += gap;
+                ++num_gaps;
+            }
+        }
+        if (num_gaps && gaps)
+            bucketShift = ceilLog2(std::max<Tick>(3 * gaps / num_gaps, 1));
+    }
+
+    buckets.assign(num_buckets, NULL);
+    for (Event *bin : bins)
+        insertBin(bin);
+}
+
+std::vector<Event *>
+EventQueue::sortedBins() const
+{
+    std::vector<Event *> bins;
+    for (Event *bin : buckets) {
+        for (; bin; bin = bin->nextBin)
+            bins.push_back(bin);
+    }
+    std::sort(bins.begin(), bins.end(),
+              [](Event *l, Event *r) { return *l < *r; });
+    return bins;
+}
+
+#else
+
+void
+EventQueue::insert(Event *event)
+{
+    // Deal with the head case
+    if (!head || *event <= *head) {
+        head = Event::insertBefore(event, head);
+        return;
+    }
+
+    // Figure out either which 'in bin' list we are on, or where a new list
+    // needs to be inserted
+    Event *prev = head;
+    Event *curr = head->nextBin;
+    while (curr && *curr < *event) {
+        prev = curr;
+        curr = curr->nextBin;
+    }
+
+    // Note: this operation may render all nextBin pointers on the
+    // prev 'in bin' list stale (except for the top one)
+    prev->nextBin = Event::insertBefore(event, curr);
+}
+
 void
 EventQueue::remove(Event *event)
 {
@@ -200,14 +355,19 @@ EventQueue::remove(Event *event)
     prev->nextBin = Event::removeItem(event, curr);
 }
 
+#endif
+
 Event *
 EventQueue::serviceOne()
 {
     std::lock_guard<EventQueue> lock(*this);
     Event *event = head;
-    Event *next = head->nextInBin;
     event->flags.clear(Event::Scheduled);
 
+#if USE_CALENDAR_EVENTQ
+    removeHead();
+#else
+    Event *next = head->nextInBin;
     if (next) {
         // update the next bin pointer since it could be stale
         next->nextBin = head->nextBin;
@@ -219,6 +379,7 @@ EventQueue::serviceOne()
         // the 'in bin' list and point to the next bin list
         head = head->nextBin;
     }
+#endif
 
     // handle action
     if (!event->squashed()) {
@@ -300,6 +461,14 @@ EventQueue::dump() const
     if (empty())
         cprintf("<No Events>\n");
     else {
+#if USE_CALENDAR_EVENTQ
+        for (Event *nextInBin : sortedBins()) {
+            while (nextInBin) {
+                nextInBin->dump();
+                nextInBin = nextInBin->nextInBin;
+            }
+        }
+#else
         Event *nextBin = head;
         while (nextBin) {
             Event *nextInBin = nextBin;
@@ -310,6 +479,7 @@ EventQueue::dump() const
 
             nextBin = nextBin->nextBin;
         }
+#endif
     }
 
     cprintf("============================================================\n");
@@ -323,9 +493,42 @@ EventQueue::debugVerify() const
     Tick time = 0;
     short priority = 0;
 
+#if USE_CALENDAR_EVENTQ
+    size_t num_events = 0;
+    for (size_t i = 0; i < buckets.size(); ++i) {
+        for (Event *bin = buckets[i]; bin; bin = bin->nextBin) {
+            if (bucketIndex(bin->when()) != i) {
+                cprintf("bin in the wrong bucket!");
+                bin->dump();
+                return false;
+            }
+            if (bin->nextBin && !(*bin < *bin->nextBin)) {
+                cprintf("bucket not sorted!");
+                bin->dump();
+                return false;
+            }
+            if (*bin < *head) {
+                cprintf("head is not the earliest bin!");
+                bin->dump();
+                return false;
+            }
+            for (Event *e = bin; e; e = e->nextInBin)
+                ++num_events;
+        }
+    }
+    if (num_events != numEvents) {
+        cprintf("%d events in the buckets, %d counted\n",
+                num_events, numEvents);
+        return false;
+    }
+
+    std::vector<Event *> bins = sortedBins();
+    for (Event *nextInBin : bins) {
+#else
     Event *nextBin = head;
     while (nextBin) {
         Event *nextInBin = nextBin;
+#endif
         while (nextInBin) {
             if (nextInBin->when() < time) {
                 cprintf("time goes backwards!");
@@ -351,7 +554,9 @@ EventQueue::debugVerify() const
             nextInBin = nextInBin->nextInBin;
         }
 
+#if !USE_CALENDAR_EVENTQ
         nextBin = nextBin->nextBin;
+#endif
     }
 
     return true;
@@ -360,9 +565,32 @@ EventQueue::debugVerify() const
 Event*
 EventQueue::replaceHead(Event* s)
 {
+#if USE_CALENDAR_EVENTQ
+    // Hand out the events as the sorted list of bins of the default
+    // queue, and take the new ones in the same form
+    std::vector<Event *> bins = sortedBins();
+    for (size_t i = 0; i < bins.size(); ++i)
+        bins[i]->nextBin = i + 1 < bins.size() ? bins[i + 1] : NULL;
+    Event* t = bins.empty() ? NULL : bins[0];
+
+    buckets.assign(MinBuckets, NULL);
+    numEvents = 0;
+    head = s;
+    while (s) {
+        Event *next = s->nextBin;
+        insertBin(s);
+        for (Event *e = s; e; e = e->nextInBin)
+            ++numEvents;
+        s = next;
+    }
+    if (numEvents > 2 * buckets.size())
+        resize(ceilPow2(numEvents));
+    return t;
+#else
     Event* t = head;
     head = s;
     return t;
+#endif
 }
 
 void
@@ -413,8 +641,15 @@ Event::dump() const
     }
 }
 
+#if USE_CALENDAR_EVENTQ
+const size_t EventQueue::MinBuckets;
+#endif
+
 EventQueue::EventQueue(const string &n)
     : objName(n), head(NULL), _curTick(0)
+#if USE_CALENDAR_EVENTQ
+    , buckets(MinBuckets, NULL), bucketShift(10), numEvents(0)
+#endif
 {
 }
 
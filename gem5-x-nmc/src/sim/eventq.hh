@@ -46,9 +46,11 @@
 #include <memory>
 #include <mutex>
 #include <string>
+#include <vector>
 
 #include "base/flags.hh"
 #include "base/types.hh"
+#include "config/use_calendar_eventq.hh"
 #include "debug/Event.hh"
 #include "sim/serialize.hh"
 
@@ -197,6 +199,9 @@ class Event : public EventBase, public Serializable
     // linear/constant, and the lookup/removal in 'nextInBin' is
     // constant/constant.  Hopefully this is a significant improvement
     // over the current fully linear insertion.
+    //
+    // With USE_CALENDAR_EVENTQ the bins are spread over the buckets of
+    // a calendar queue, and 'nextBin' links the bins of a bucket.
     Event *nextBin;
     Event *nextInBin;
 
@@ -526,6 +531,49 @@ class EventQueue
     void insert(Event *event);
     void remove(Event *event);
 
+#if USE_CALENDAR_EVENTQ
+    /**
+     * Calendar queue of bins. A bin goes to bucket (when >> bucketShift)
+     * modulo the number of buckets, whose bins are sorted through
+     * nextBin like the list of the default queue. The bins of the next
+     * bucketWidth ticks are then found in one bucket instead of walking
+     * all the earlier bins. head is always the top of the earliest bin,
+     * which is also the first bin of its bucket.
+     *
+     * The number of buckets follows the number of events, and the
+     * bucket width the spacing of the earliest bins, so that a bucket
+     * holds a handful of bins. The order of the events is the same as
+     * in the list, so simulations are deterministic and identical with
+     * both queues.
+     */
+    std::vector<Event *> buckets;
+    int bucketShift;
+    size_t numEvents;
+
+    static const size_t MinBuckets = 16;
+
+    size_t
+    bucketIndex(Tick when) const
+    {
+        return (when >> bucketShift) & (buckets.size() - 1);
+    }
+
+    //! Earliest bin, given that no event is earlier than from.
+    Event *findHead(Tick from) const;
+
+    //! Put a whole bin in its bucket.
+    void insertBin(Event *bin);
+
+    //! Remove the top event of the earliest bin.
+    void removeHead();
+
+    //! Rebuild the calendar with num_buckets buckets.
+    void resize(size_t num_buckets);
+
+    //! All the bins, earliest first.
+    std::vector<Event *> sortedBins() const;
+#endif
+
     //! Function for adding events to the async queue. The added events
     //! are added to main event queue later. Threads, other than the
     //! owning thread, should call this function instead of insert().
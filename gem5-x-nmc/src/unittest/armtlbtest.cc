@@ -0,0 +1,387 @@
+ /*
+ * Copyright EPFL 2024
+ * Rafael Medina Morillas
+ *
+ */
+
+#include <cstdlib>
+#include <fstream>
+#include <list>
+#include <string>
+#include <vector>
+
+#include "arch/arm/table_walker.hh"
+#include "arch/arm/tlb.hh"
+#include "mem/cache/replacement_policies/lru_rp.hh"
+#include "params/ArmTLB.hh"
+#include "params/ArmTableWalker.hh"
+#include "params/LRURP.hh"
+#include "params/SrcClockDomain.hh"
+#include "params/VoltageDomain.hh"
+#include "sim/clock_domain.hh"
+#include "sim/serialize.hh"
+#include "sim/sim_object.hh"
+#include "unittest/unittest.hh"
+
+using namespace std;
+using namespace ArmISA;
+namespace {
+
+const int Size = 64;
+const Addr PageShift4K = 12;
+const Addr PageShift2M = 21;
+
+/** A TLB whose stage 2 TLB is set directly instead of through the MMU */
+class TestTLB : public TLB
+{
+  public:
+    TestTLB(const ArmTLBParams *p) : TLB(p) {}
+
+    void setStage2Tlb(TLB *tlb) { stage2Tlb = tlb; }
+};
+
+/** Names the case, keeping the name alive as the results only refer to it */
+void
+setCase(const string &name)
+{
+    static list<string> names;
+    names.push_back(name);
+    UnitTest::setCase(names.back().c_str());
+}
+
+struct NullResolver : public SimObjectResolver
+{
+    SimObject *resolveSimObject(const string &name) { return nullptr; }
+};
+
+/** A valid non-global EL1 entry of a 2^n-byte page */
+TlbEntry
+makeEntry(Addr va, Addr pa, int n, uint16_t asid, bool secure)
+{
+    TlbEntry entry;
+    entry.valid = true;
+    entry.N = n;
+    entry.size = (Addr(1) << n) - 1;
+    entry.vpn = va >> n;
+    entry.pfn = pa >> n;
+    entry.asid = asid;
+    entry.vmid = 0;
+    entry.el = 1;
+    entry.ns = !secure;
+    entry.nstid = !secure;
+    entry.longDescFormat = true;
+    return entry;
+}
+
+ClockDomain *
+clockDomain()
+{
+    VoltageDomainParams *vd = new VoltageDomainParams;
+    vd->name = "voltage_domain";
+    vd->eventq_index = 0;
+    vd->voltage.push_back(1.0);
+
+    SrcClockDomainParams *cd = new SrcClockDomainParams;
+    cd->name = "clk_domain";
+    cd->eventq_index = 0;
+    cd->clock.push_back(1000);
+    cd->domain_id = -1;
+    cd->init_perf_level = 0;
+    cd->voltage_domain = vd->create();
+    return cd->create();
+}
+
+TestTLB *
+makeTLB(const string &name, int assoc, bool stage2, ClockDomain *clk_domain)
+{
+    ArmTableWalkerParams *wp = new ArmTableWalkerParams;
+    wp->name = name + ".walker";
+    wp->eventq_index = 0;
+    wp->clk_domain = clk_domain;
+    wp->default_p_state = Enums::UNDEFINED;
+    wp->p_state_clk_gate_bins = 20;
+    wp->p_state_clk_gate_min = 1000;
+    wp->p_state_clk_gate_max = 1000000000000ULL;
+    wp->is_stage2 = stage2;
+    wp->num_squash_per_cycle = 2;
+    wp->sys = nullptr;
+    wp->port_port_connection_count = 0;
+
+    LRURPParams *rp = new LRURPParams;
+    rp->name = name + ".replacement_policy";
+    rp->eventq_index = 0;
+
+    ArmTLBParams *p = new ArmTLBParams;
+    p->name = name;
+    p->eventq_index = 0;
+    p->size = Size;
+    p->assoc = assoc;
+    p->is_stage2 = stage2;
+    p->replacement_policy = rp->create();
+    p->sys = nullptr;
+    p->walker = wp->create();
+
+    TestTLB *tlb = new TestTLB(p);
+    tlb->regStats();
+    tlb->regProbePoints();
+    return tlb;
+}
+
+/** Physical address of va, or 1 if the TLB misses */
+Addr
+translate(TLB *tlb, Addr va, uint16_t asid, bool secure)
+{
+    TlbEntry *te = tlb->lookup(va, asid, 0, false, secure, true, false, 1);
+    return te ? te->pAddr(va) : 1;
+}
+
+/**
+ * Consecutive pages of two address spaces, a secure page and a large one.
+ * They take at most four ways of a set in the geometries tested, so none
+ * of them is evicted.
+ */
+struct Pages
+{
+    vector<Addr> vas;
+
+    Pages()
+    {
+        for (int i = 0; i < 8; ++i)
+            vas.push_back(Addr(0x10000000) + (Addr(i) << PageShift4K));
+    }
+
+    void
+    insert(TLB *tlb) const
+    {
+        for (int i = 0; i < vas.size(); ++i) {
+            TlbEntry a = makeEntry(vas[i], pa(i, 1), PageShift4K, 1, false);
+            TlbEntry b = makeEntry(vas[i], pa(i, 2), PageShift4K, 2, false);
+            tlb->insert(vas[i], a);
+            tlb->insert(vas[i], b);
+        }
+        TlbEntry s = makeEntry(secureVa, 0x7000, PageShift4K, 1, true);
+        TlbEntry l = makeEntry(largeVa, 0x40000000, PageShift2M, 1, false);
+        tlb->insert(secureVa, s);
+        tlb->insert(largeVa, l);
+    }
+
+    static Addr pa(int i, int asid) { return (0x1000 + i * 2 + asid) << 12; }
+
+    /** Whether the pages of an address space all hit */
+    bool
+    hits(TLB *tlb, uint16_t asid) const
+    {
+        bool ok = true;
+        for (int i = 0; i < vas.size(); ++i)
+            ok = ok && translate(tlb, vas[i] + 0x10, asid, false) ==
+                pa(i, asid) + 0x10;
+        return ok;
+    }
+
+    /** Whether the pages of an address space all miss */
+    bool
+    misses(TLB *tlb, uint16_t asid) const
+    {
+        bool ok = true;
+        for (Addr va : vas)
+            ok = ok && translate(tlb, va, asid, false) == 1;
+        return ok;
+    }
+
+    bool
+    secureHits(TLB *tlb) const
+    {
+        return translate(tlb, secureVa + 4, 1, true) == 0x7004;
+    }
+
+    bool
+    largeHits(TLB *tlb) const
+    {
+        return translate(tlb, largeVa + 0x12345, 1, false) ==
+            0x40000000 + 0x12345;
+    }
+
+    const Addr secureVa = 0x20000000;
+    const Addr largeVa = 0x80000000;
+};
+
+} // anonymous namespace
+
+int
+main()
+{
+    curEventQueue(getEventQueue(0));
+    ClockDomain *clk_domain = clockDomain();
+    Pages pages;
+
+    // Fully associative as the default configurations, and set
+    // associative with sets of 4 ways
+    for (int assoc : {0, 4}) {
+        const string geometry = assoc ? " (4 ways)" : " (fully assoc)";
+        const string name = assoc ? "tlb4" : "tlb0";
+        TestTLB *tlb = makeTLB(name, assoc, false, clk_domain);
+        TestTLB *s2_tlb = makeTLB(name + ".s2", assoc, true, clk_domain);
+        tlb->setStage2Tlb(s2_tlb);
+
+        setCase("hit after insert" + geometry);
+        {
+            EXPECT_TRUE(pages.misses(tlb, 1));
+            pages.insert(tlb);
+            EXPECT_TRUE(pages.hits(tlb, 1));
+            EXPECT_TRUE(pages.hits(tlb, 2));
+            EXPECT_TRUE(pages.secureHits(tlb));
+            EXPECT_TRUE(pages.largeHits(tlb));
+            EXPECT_EQ(translate(tlb, pages.vas[0], 3, false), 1);
+            EXPECT_EQ(translate(tlb, pages.largeVa + (1 << 21), 1, false), 1);
+        }
+
+        setCase("a full set evicts, the rest of the TLB keeps" +
+                 geometry);
+        {
+            // Twice the capacity on one page each, a tick apart, only the
+            // last ones inserted stay
+            tlb->flushAll();
+            for (int i = 0; i < 2 * Size; ++i) {
+                curEventQueue()->setCurTick(curTick() + 1);
+                TlbEntry e = makeEntry(Addr(i) << 12, Addr(i) << 12,
+                                       PageShift4K, 1, false);
+                tlb->insert(Addr(i) << 12, e);
+            }
+            int hits = 0;
+            for (int i = 0; i < 2 * Size; ++i)
+                hits += translate(tlb, Addr(i) << 12, 1, false) != 1;
+            EXPECT_EQ(hits, Size);
+            for (int i = Size; i < 2 * Size; ++i)
+                EXPECT_EQ(translate(tlb, Addr(i) << 12, 1, false), Addr(i) << 12);
+        }
+
+        setCase("flushAll" + geometry);
+        {
+            tlb->flushAll();
+            pages.insert(tlb);
+            tlb->flushAll();
+            EXPECT_TRUE(pages.misses(tlb, 1));
+            EXPECT_TRUE(pages.misses(tlb, 2));
+            EXPECT_FALSE(pages.secureHits(tlb));
+            EXPECT_FALSE(pages.largeHits(tlb));
+        }
+
+        setCase("flushAllSecurity" + geometry);
+        {
+            pages.insert(tlb);
+            tlb->flushAllSecurity(false, 1);
+            EXPECT_TRUE(pages.misses(tlb, 1));
+            EXPECT_TRUE(pages.misses(tlb, 2));
+            EXPECT_FALSE(pages.largeHits(tlb));
+            EXPECT_TRUE(pages.secureHits(tlb));
+            tlb->flushAllSecurity(true, 1);
+            EXPECT_FALSE(pages.secureHits(tlb));
+        }
+
+        setCase("flushAllNs" + geometry);
+        {
+            pages.insert(tlb);
+            tlb->flushAllNs(false, 1);
+            EXPECT_TRUE(pages.misses(tlb, 1));
+            EXPECT_TRUE(pages.misses(tlb, 2));
+            EXPECT_FALSE(pages.largeHits(tlb));
+            EXPECT_TRUE(pages.secureHits(tlb));
+        }
+
+        setCase("flushMvaAsid" + geometry);
+        {
+            tlb->flushAll();
+            pages.insert(tlb);
+            tlb->flushMvaAsid(pages.vas[3] + 0x80, 1, false, 1);
+            EXPECT_EQ(translate(tlb, pages.vas[3], 1, false), 1);
+            EXPECT_EQ(translate(tlb, pages.vas[3], 2, false),
+                      Pages::pa(3, 2));
+            EXPECT_EQ(translate(tlb, pages.vas[4], 1, false),
+                      Pages::pa(4, 1));
+            tlb->flushMvaAsid(pages.largeVa + 0x54321, 1, false, 1);
+            EXPECT_FALSE(pages.largeHits(tlb));
+            EXPECT_TRUE(pages.secureHits(tlb));
+        }
+
+        setCase("flushAsid" + geometry);
+        {
+            tlb->flushAll();
+            pages.insert(tlb);
+            tlb->flushAsid(2, false, 1);
+            EXPECT_TRUE(pages.misses(tlb, 2));
+            EXPECT_TRUE(pages.hits(tlb, 1));
+            EXPECT_TRUE(pages.largeHits(tlb));
+            EXPECT_TRUE(pages.secureHits(tlb));
+        }
+
+        setCase("flushMva" + geometry);
+        {
+            tlb->flushAll();
+            pages.insert(tlb);
+            tlb->flushMva(pages.vas[5], false, false, 1);
+            EXPECT_EQ(translate(tlb, pages.vas[5], 1, false), 1);
+            EXPECT_EQ(translate(tlb, pages.vas[5], 2, false), 1);
+            EXPECT_EQ(translate(tlb, pages.vas[6], 2, false),
+                      Pages::pa(6, 2));
+            tlb->flushMva(pages.secureVa, true, false, 1);
+            EXPECT_FALSE(pages.secureHits(tlb));
+            EXPECT_TRUE(pages.largeHits(tlb));
+        }
+
+        setCase("flushIpaVmid" + geometry);
+        {
+            tlb->flushAll();
+            s2_tlb->flushAll();
+            pages.insert(tlb);
+            pages.insert(s2_tlb);
+            tlb->flushIpaVmid(pages.vas[2], false, false, 1);
+            EXPECT_EQ(translate(s2_tlb, pages.vas[2], 1, false), 1);
+            EXPECT_EQ(translate(s2_tlb, pages.vas[2], 2, false), 1);
+            EXPECT_EQ(translate(s2_tlb, pages.vas[1], 1, false),
+                      Pages::pa(1, 1));
+            // the stage 1 entries are left alone
+            EXPECT_TRUE(pages.hits(tlb, 1));
+        }
+
+        setCase("takeOverFrom keeps the translations" + geometry);
+        {
+            TestTLB *other = makeTLB(name + ".other", assoc ? 0 : 8, false,
+                                     clk_domain);
+            other->setStage2Tlb(makeTLB(name + ".other.s2", 0, true,
+                                        clk_domain));
+            other->takeOverFrom(tlb);
+            EXPECT_TRUE(pages.hits(other, 1));
+            EXPECT_TRUE(pages.hits(other, 2));
+            EXPECT_TRUE(pages.secureHits(other));
+            EXPECT_TRUE(pages.largeHits(other));
+            other->flushAll();
+            EXPECT_TRUE(pages.misses(other, 1));
+            EXPECT_FALSE(pages.largeHits(other));
+        }
+
+        setCase("a checkpoint restores into another geometry" +
+                 geometry);
+        {
+            char dir[] = "/tmp/armtlbtestXXXXXX";
+            EXPECT_TRUE(mkdtemp(dir) != nullptr);
+            {
+                ofstream cpt(string(dir) + "/" + CheckpointIn::baseFilename);
+                tlb->serializeSection(cpt, "tlb");
+            }
+            NullResolver resolver;
+            CheckpointIn cp(dir, resolver);
+            TestTLB *other = makeTLB(name + ".restored", assoc ? 0 : 8, false,
+                                     clk_domain);
+            other->unserializeSection(cp, "tlb");
+            EXPECT_TRUE(pages.hits(other, 1));
+            EXPECT_TRUE(pages.hits(other, 2));
+            EXPECT_TRUE(pages.secureHits(other));
+            EXPECT_TRUE(pages.largeHits(other));
+            EXPECT_EQ(translate(other, pages.vas[0], 3, false), 1);
+            remove((string(dir) + "/" + CheckpointIn::baseFilename).c_str());
+            remove(dir);
+        }
+    }
+
+    return UnitTest::printResults();
+}
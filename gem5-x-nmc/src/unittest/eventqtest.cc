@@ -0,0 +1,313 @@
+ /*
+ * Copyright EPFL 2024
+ * Rafael Medina Morillas
+ *
+ */
+
+#include <random>
+#include <set>
+#include <tuple>
+#include <vector>
+
+#include "sim/eventq_impl.hh"
+#include "unittest/unittest.hh"
+
+using namespace std;
+using UnitTest::setCase;
+
+namespace {
+
+const int NumEvents = 5000;
+const int VerifyPeriod = 997;
+
+struct TestEvent : public Event
+{
+    int id;
+    vector<int> *serviced;
+
+    TestEvent(int _id, Priority prio, vector<int> *_serviced)
+        : Event(prio), id(_id), serviced(_serviced)
+    {}
+
+    void process() override { serviced->push_back(id); }
+};
+
+/**
+ * Reference of the order of an event queue: by time, then priority, and
+ * the last event scheduled first among the ones of the same time and
+ * priority.
+ */
+class ReferenceQueue
+{
+  public:
+    typedef tuple<Tick, Event::Priority, long, TestEvent *> Key;
+
+    ReferenceQueue(int num_events)
+        : seq(0), keys(num_events), squashed(num_events, false)
+    {}
+
+    void
+    schedule(TestEvent *event, Tick when)
+    {
+        keys[event->id] = Key(when, event->priority(), -(++seq), event);
+        order.insert(keys[event->id]);
+        squashed[event->id] = false;
+    }
+
+    void
+    deschedule(TestEvent *event)
+    {
+        order.erase(keys[event->id]);
+        squashed[event->id] = false;
+    }
+
+    void squash(TestEvent *event) { squashed[event->id] = true; }
+
+    bool empty() const { return order.empty(); }
+    size_t size() const { return order.size(); }
+    TestEvent *head() const { return get<3>(*order.begin()); }
+    Tick nextTick() const { return get<0>(*order.begin()); }
+
+    /** Remove the head, returning whether it is serviced or squashed */
+    bool
+    serviceOne()
+    {
+        TestEvent *event = head();
+        order.erase(order.begin());
+        bool processed = !squashed[event->id];
+        squashed[event->id] = false;
+        return processed;
+    }
+
+  private:
+    long seq;
+    set<Key> order;
+    vector<Key> keys;
+    vector<bool> squashed;
+};
+
+/**
+ * Applies the same random operations to an event queue and to the
+ * reference, and checks after each one that both have the same head.
+ */
+class Checker
+{
+  public:
+    Checker(EventQueue &_eq, vector<TestEvent *> &_events,
+            ReferenceQueue &_ref, vector<int> &_serviced)
+        : eq(_eq), events(_events), ref(_ref), serviced(_serviced),
+          rng(1), ok(true), verified(true), steps(0)
+    {}
+
+    TestEvent *randomEvent() { return events[rng() % events.size()]; }
+
+    /** A random time from now, at most max_delay away */
+    Tick
+    randomTick(Tick max_delay)
+    {
+        return eq.getCurTick() + rng() % (max_delay + 1);
+    }
+
+    void
+    schedule(TestEvent *event, Tick when)
+    {
+        eq.schedule(event, when);
+        ref.schedule(event, when);
+        check();
+    }
+
+    void
+    deschedule(TestEvent *event)
+    {
+        eq.deschedule(event);
+        ref.deschedule(event);
+        check();
+    }
+
+    void
+    reschedule(TestEvent *event, Tick when)
+    {
+        if (event->scheduled())
+            ref.deschedule(event);
+        eq.reschedule(event, when, true);
+        ref.schedule(event, when);
+        check();
+    }
+
+    void
+    squash(TestEvent *event)
+    {
+        event->squash();
+        ref.squash(event);
+        check();
+    }
+
+    void
+    serviceOne()
+    {
+        int id = ref.head()->id;
+        size_t before = serviced.size();
+        bool processed = ref.serviceOne();
+        eq.serviceOne();
+
+        if (processed)
+            ok = ok && serviced.size() == before + 1 && serviced.back() == id;
+        else
+            ok = ok && serviced.size() == before;
+        check();
+    }
+
+    /** A random operation, scheduling events up to max_delay away */
+    void
+    randomStep(Tick max_delay)
+    {
+        TestEvent *event = randomEvent();
+        switch (rng() % 8) {
+          case 0:
+          case 1:
+            if (event->scheduled())
+                deschedule(event);
+            else
+                schedule(event, randomTick(max_delay));
+            break;
+          case 2:
+          case 3:
+            reschedule(event, randomTick(max_delay));
+            break;
+          case 4:
+            if (event->scheduled() && !event->squashed())
+                squash(event);
+            break;
+          default:
+            if (!ref.empty())
+                serviceOne();
+            break;
+        }
+    }
+
+    void
+    check()
+    {
+        ok = ok && eq.empty() == ref.empty();
+        if (!ref.empty()) {
+            ok = ok && eq.getHead() == ref.head() &&
+                eq.nextTick() == ref.nextTick();
+        }
+        if (++steps % VerifyPeriod == 0)
+            verified = verified && eq.debugVerify();
+    }
+
+    EventQueue &eq;
+    vector<TestEvent *> &events;
+    ReferenceQueue &ref;
+    vector<int> &serviced;
+
+    mt19937_64 rng;
+    bool ok;
+    bool verified;
+    long steps;
+};
+
+} // anonymous namespace
+
+int
+main()
+{
+    EventQueue eq("eventqtest");
+    curEventQueue(&eq);
+
+    vector<int> serviced;
+    vector<TestEvent *> events;
+    mt19937_64 prio_rng(2);
+    for (int i = 0; i < NumEvents; ++i) {
+        events.push_back(new TestEvent(i, Event::Priority(prio_rng() % 3) - 1,
+                                       &serviced));
+    }
+    ReferenceQueue ref(NumEvents);
+    Checker checker(eq, events, ref, serviced);
+
+    setCase("insert and remove, events close in time");
+    {
+        for (int i = 0; i < 200000; ++i)
+            checker.randomStep(50);
+        EXPECT_TRUE(checker.ok);
+        EXPECT_TRUE(checker.verified);
+    }
+
+    setCase("insert and remove, events far apart");
+    {
+        for (int i = 0; i < 200000; ++i)
+            checker.randomStep(i % 2 ? 50 : 1000000);
+        EXPECT_TRUE(checker.ok);
+        EXPECT_TRUE(checker.verified);
+    }
+
+    setCase("resize while growing and shrinking");
+    {
+        // Every event pending, then the queue drained down to a few,
+        // twice with a different spacing of the events
+        for (Tick max_delay : {Tick(100), Tick(10000000)}) {
+            for (TestEvent *event : events) {
+                if (!event->scheduled())
+                    checker.schedule(event, checker.randomTick(max_delay));
+            }
+            EXPECT_EQ(ref.size(), events.size());
+            while (ref.size() > 4)
+                checker.serviceOne();
+        }
+        EXPECT_TRUE(checker.ok);
+        EXPECT_TRUE(eq.debugVerify());
+    }
+
+    setCase("squashed events are skipped");
+    {
+        for (TestEvent *event : events) {
+            if (!event->scheduled())
+                checker.schedule(event, checker.randomTick(1000));
+        }
+        for (int i = 0; i < NumEvents; i += 2)
+            checker.squash(events[i]);
+        while (!ref.empty())
+            checker.serviceOne();
+        EXPECT_TRUE(checker.ok);
+        EXPECT_TRUE(eq.empty());
+    }
+
+    setCase("replaceHead hands out and takes back the events");
+    {
+        for (int i = 0; i < NumEvents / 2; ++i)
+            checker.schedule(events[i], checker.randomTick(100000));
+
+        // Service other events on the emptied queue, as Ruby does during
+        // the cache warmup, and then put the original ones back
+        Tick tick = eq.getCurTick();
+        Event *saved = eq.replaceHead(nullptr);
+        EXPECT_TRUE(eq.empty());
+        EXPECT_TRUE(eq.debugVerify());
+
+        ReferenceQueue other_ref(NumEvents);
+        Checker other(eq, events, other_ref, serviced);
+        for (int i = NumEvents / 2; i < NumEvents; ++i)
+            other.schedule(events[i], other.randomTick(1000));
+        while (!other_ref.empty())
+            other.serviceOne();
+        EXPECT_TRUE(other.ok);
+
+        EXPECT_EQ(eq.replaceHead(saved), nullptr);
+        eq.setCurTick(tick);
+        checker.check();
+        EXPECT_TRUE(eq.debugVerify());
+
+        for (int i = 0; i < 100000; ++i)
+            checker.randomStep(1000);
+        while (!ref.empty())
+            checker.serviceOne();
+        EXPECT_TRUE(checker.ok);
+        EXPECT_TRUE(checker.verified);
+    }
+
+    for (TestEvent *event : events)
+        delete event;
+
+    return UnitTest::printResults();
+}
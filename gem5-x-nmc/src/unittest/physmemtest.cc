@@ -0,0 +1,279 @@
+ /*
+ * Copyright EPFL 2024
+ * Rafael Medina Morillas
+ *
+ */
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "mem/physical.hh"
+#include "mem/simple_mem.hh"
+#include "params/SimpleMemory.hh"
+#include "params/SrcClockDomain.hh"
+#include "params/VoltageDomain.hh"
+#include "sim/clock_domain.hh"
+#include "sim/serialize.hh"
+#include "sim/sim_object.hh"
+#include "unittest/unittest.hh"
+
+using namespace std;
+using UnitTest::setCase;
+
+namespace {
+
+const string Name = "system.physmem";
+
+// Not a whole number of the 4 MiB chunks of the sparse checkpoints
+const uint64_t MemSize = (10 << 20) + (8 << 10);
+
+struct NullResolver : public SimObjectResolver
+{
+    SimObject *resolveSimObject(const string &name) { return nullptr; }
+};
+
+ClockDomain *
+clockDomain()
+{
+    VoltageDomainParams *vd = new VoltageDomainParams;
+    vd->name = "voltage_domain";
+    vd->eventq_index = 0;
+    vd->voltage.push_back(1.0);
+
+    SrcClockDomainParams *cd = new SrcClockDomainParams;
+    cd->name = "clk_domain";
+    cd->eventq_index = 0;
+    cd->clock.push_back(1000);
+    cd->domain_id = -1;
+    cd->init_perf_level = 0;
+    cd->voltage_domain = vd->create();
+    return cd->create();
+}
+
+/** A memory and the physical memory giving it its backing store */
+struct Memory
+{
+    SimpleMemory *mem;
+    PhysicalMemory *phys;
+
+    Memory(ClockDomain *clk_domain, bool sparse, bool lazy)
+    {
+        SimpleMemoryParams *p = new SimpleMemoryParams;
+        p->name = "system.mem";
+        p->eventq_index = 0;
+        p->clk_domain = clk_domain;
+        p->default_p_state = Enums::UNDEFINED;
+        p->p_state_clk_gate_bins = 20;
+        p->p_state_clk_gate_min = 1000;
+        p->p_state_clk_gate_max = 1000000000000ULL;
+        p->port_port_connection_count = 0;
+        p->range = AddrRange(0, MemSize - 1);
+        p->null = false;
+        p->in_addr_map = true;
+        p->kvm_map = true;
+        p->conf_table_reported = true;
+        p->latency = 30000;
+        p->latency_var = 0;
+        p->bandwidth = 73.0;
+        mem = p->create();
+        phys = new PhysicalMemory(Name, {mem}, false, sparse, 2, lazy);
+    }
+
+    ~Memory() { delete phys; }
+
+    uint8_t *data() const { return phys->getBackingStore()[0].pmem; }
+};
+
+/**
+ * Contents with pages of random data among zero ones: the first and last
+ * pages, pages on both sides of a chunk boundary, and a page with a single
+ * non-zero byte.
+ */
+vector<uint8_t>
+contents()
+{
+    vector<uint8_t> data(MemSize, 0);
+    mt19937 rng(1);
+    auto fill = [&](uint64_t offset, uint64_t size) {
+        for (uint64_t i = offset; i < offset + size; ++i)
+            data[i] = rng();
+    };
+    fill(0, 4096);
+    fill((4 << 20) - 4096, 8192);
+    fill(5 << 20, 3 * 4096 + 100);
+    fill(MemSize - 4096, 4096);
+    data[(8 << 20) + 17] = 1;
+    return data;
+}
+
+string
+checkpointFile(const string &dir)
+{
+    return dir + "/" + CheckpointIn::baseFilename;
+}
+
+void
+checkpoint(const Memory &memory, const string &dir)
+{
+    CheckpointIn::setDir(dir);
+    ofstream cpt(checkpointFile(dir));
+    memory.phys->serializeSection(cpt, Name);
+}
+
+bool
+restoresTo(ClockDomain *clk_domain, const string &dir, bool lazy,
+           const vector<uint8_t> &expected)
+{
+    Memory restored(clk_domain, true, lazy);
+    NullResolver resolver;
+    CheckpointIn cp(dir, resolver);
+    restored.phys->unserializeSection(cp, Name);
+    return !memcmp(restored.data(), expected.data(), MemSize);
+}
+
+/** Whether restoring the checkpoint ends the simulation with an error */
+bool
+restoreFails(ClockDomain *clk_domain, const string &dir)
+{
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid == 0) {
+        restoresTo(clk_domain, dir, false, vector<uint8_t>(MemSize));
+        _exit(0);
+    }
+    int status;
+    return waitpid(pid, &status, 0) == pid &&
+        !(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+}
+
+/** Rewrite the lines of the checkpoint file */
+void
+editCheckpoint(const string &dir, const function<string(string)> &edit)
+{
+    ifstream in(checkpointFile(dir));
+    stringstream out;
+    string line;
+    while (getline(in, line))
+        out << edit(line) << "\n";
+    in.close();
+    ofstream(checkpointFile(dir)) << out.str();
+}
+
+string
+tempDir()
+{
+    char dir[] = "/tmp/physmemtestXXXXXX";
+    if (!mkdtemp(dir))
+        abort();
+    return dir;
+}
+
+void
+removeDir(const string &dir)
+{
+    string cmd = "rm -rf " + dir;
+    if (system(cmd.c_str()))
+        abort();
+}
+
+} // anonymous namespace
+
+int
+main()
+{
+    curEventQueue(getEventQueue(0));
+    ClockDomain *clk_domain = clockDomain();
+    const vector<uint8_t> expected = contents();
+
+    setCase("sparse checkpoint, eager and lazy restore");
+    {
+        string dir = tempDir();
+        {
+            Memory memory(clk_domain, true, false);
+            memcpy(memory.data(), expected.data(), MemSize);
+            checkpoint(memory, dir);
+        }
+        EXPECT_TRUE(restoresTo(clk_domain, dir, false, expected));
+        EXPECT_TRUE(restoresTo(clk_domain, dir, true, expected));
+
+        // The image is mapped copy-on-write, and reused by the next restore
+        {
+            Memory restored(clk_domain, true, true);
+            NullResolver resolver;
+            CheckpointIn cp(dir, resolver);
+            restored.phys->unserializeSection(cp, Name);
+            memset(restored.data(), 0xff, 3 * 4096);
+        }
+        EXPECT_TRUE(restoresTo(clk_domain, dir, true, expected));
+        removeDir(dir);
+    }
+
+    setCase("gzip checkpoint restores into a sparse memory");
+    {
+        string dir = tempDir();
+        {
+            Memory memory(clk_domain, false, false);
+            memcpy(memory.data(), expected.data(), MemSize);
+            checkpoint(memory, dir);
+        }
+        EXPECT_TRUE(restoresTo(clk_domain, dir, false, expected));
+        EXPECT_TRUE(restoresTo(clk_domain, dir, true, expected));
+        removeDir(dir);
+    }
+
+    setCase("checkpoint of an older version, without the format");
+    {
+        string dir = tempDir();
+        {
+            Memory memory(clk_domain, false, false);
+            memcpy(memory.data(), expected.data(), MemSize);
+            checkpoint(memory, dir);
+        }
+        editCheckpoint(dir, [](string line) {
+            return line.compare(0, 7, "format=") ? line : "";
+        });
+        EXPECT_TRUE(restoresTo(clk_domain, dir, false, expected));
+        removeDir(dir);
+    }
+
+    setCase("unknown formats are rejected");
+    {
+        string dir = tempDir();
+        {
+            Memory memory(clk_domain, true, false);
+            memcpy(memory.data(), expected.data(), MemSize);
+            checkpoint(memory, dir);
+        }
+        editCheckpoint(dir, [](string line) {
+            return line == "format=sparse" ? "format=zstd" : line;
+        });
+        EXPECT_TRUE(restoreFails(clk_domain, dir));
+
+        // A sparse store of another version
+        editCheckpoint(dir, [](string line) {
+            return line == "format=zstd" ? "format=sparse" : line;
+        });
+        EXPECT_FALSE(restoreFails(clk_domain, dir));
+        string store = dir + "/" + Name + ".store0.spmem";
+        FILE *f = fopen(store.c_str(), "r+b");
+        EXPECT_TRUE(f != nullptr);
+        fseek(f, 8, SEEK_SET);
+        uint32_t version = 0xdead;
+        fwrite(&version, sizeof(version), 1, f);
+        fclose(f);
+        EXPECT_TRUE(restoreFails(clk_domain, dir));
+        removeDir(dir);
+    }
+
+    return UnitTest::printResults();
+}
@@ -0,0 +1,158 @@
+ /*
+ * Copyright EPFL 2024
+ * Rafael Medina Morillas
+ *
+ */
+
+#include <cstdint>
+#include <memory>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "base/slab_pool.hh"
+#include "unittest/unittest.hh"
+
+using namespace std;
+using UnitTest::setCase;
+
+namespace {
+
+typedef SlabPool<48> Pool;
+
+const int NumBlocks = 1000;
+const int NumThreads = 4;
+
+/** Blocks a pool gives before the ones in freed all came back */
+int
+allocationsUntilBack(const set<void *> &freed, vector<void *> &taken)
+{
+    // the rest of the current slab, and then the remote free list
+    const int limit = freed.size() + 64 * 1024 / 48;
+    set<void *> missing(freed);
+    int allocations = 0;
+    while (!missing.empty() && allocations < limit) {
+        void *p = Pool::allocate();
+        taken.push_back(p);
+        missing.erase(p);
+        ++allocations;
+    }
+    return missing.empty() ? allocations : -1;
+}
+
+struct Object
+{
+    uint64_t a, b, c;
+};
+
+} // anonymous namespace
+
+int
+main()
+{
+    setCase("blocks are aligned, distinct and reused");
+    {
+        vector<void *> blocks;
+        for (int i = 0; i < NumBlocks; ++i)
+            blocks.push_back(Pool::allocate());
+        set<void *> distinct(blocks.begin(), blocks.end());
+        EXPECT_EQ(distinct.size(), blocks.size());
+
+        bool aligned = true;
+        for (void *p : blocks)
+            aligned = aligned &&
+                reinterpret_cast<uintptr_t>(p) % alignof(max_align_t) == 0;
+        EXPECT_TRUE(aligned);
+
+        void *last = blocks.back();
+        Pool::release(last);
+        EXPECT_EQ(Pool::allocate(), last);
+
+        for (void *p : blocks)
+            Pool::release(p);
+    }
+
+    setCase("blocks freed on another thread go back to their pool");
+    {
+        vector<void *> blocks;
+        for (int i = 0; i < NumBlocks; ++i)
+            blocks.push_back(Pool::allocate());
+        set<void *> freed(blocks.begin(), blocks.end());
+
+        void *other_block = nullptr;
+        thread other([&blocks, &other_block]() {
+            for (void *p : blocks)
+                Pool::release(p);
+            // the pool of this thread did not take them
+            other_block = Pool::allocate();
+        });
+        other.join();
+        EXPECT_EQ(freed.count(other_block), 0);
+        Pool::release(other_block);
+
+        vector<void *> taken;
+        EXPECT_TRUE(allocationsUntilBack(freed, taken) > 0);
+        for (void *p : taken)
+            Pool::release(p);
+    }
+
+    setCase("concurrent frees from several threads");
+    {
+        vector<void *> blocks;
+        for (int i = 0; i < NumBlocks * NumThreads; ++i)
+            blocks.push_back(Pool::allocate());
+        set<void *> freed(blocks.begin(), blocks.end());
+
+        vector<thread> threads;
+        for (int t = 0; t < NumThreads; ++t) {
+            threads.emplace_back([&blocks, t]() {
+                for (int i = t; i < NumBlocks * NumThreads; i += NumThreads)
+                    Pool::release(blocks[i]);
+            });
+        }
+        for (auto &t : threads)
+            t.join();
+
+        vector<void *> taken;
+        EXPECT_TRUE(allocationsUntilBack(freed, taken) > 0);
+        set<void *> distinct(taken.begin(), taken.end());
+        EXPECT_EQ(distinct.size(), taken.size());
+        for (void *p : taken)
+            Pool::release(p);
+    }
+
+    setCase("shared objects released on another thread");
+    {
+        vector<shared_ptr<Object>> objects;
+        for (int i = 0; i < NumBlocks; ++i)
+            objects.push_back(allocate_shared<Object>(
+                SlabAllocator<Object>(), Object{uint64_t(i), 0, 0}));
+
+        bool values = true;
+        for (int i = 0; i < NumBlocks; ++i)
+            values = values && objects[i]->a == uint64_t(i);
+        EXPECT_TRUE(values);
+
+        thread other([&objects]() { objects.clear(); });
+        other.join();
+        EXPECT_TRUE(objects.empty());
+    }
+
+    setCase("buffers come from the pool of their size");
+    {
+        for (size_t size : {1, 16, 17, 64, 100, 256}) {
+            char *buf = static_cast<char *>(slabBufferAllocate(size));
+            for (size_t i = 0; i < size; ++i)
+                buf[i] = char(i);
+            bool kept = true;
+            for (size_t i = 0; i < size; ++i)
+                kept = kept && buf[i] == char(i);
+            EXPECT_TRUE(kept);
+            slabBufferRelease(buf, size);
+            EXPECT_EQ(slabBufferAllocate(size), buf);
+            slabBufferRelease(buf, size);
+        }
+    }
+
+    return UnitTest::printResults();
+}
@@ -0,0 +1,84 @@
+#  /*
+#  * Copyright EPFL 2024
+#  * Rafael Medina Morillas
+#  *
+#  */
+
+# MemTest of a memory system with the NMC memory on its own event queue
+# and thread (--nmc_parallel). The second memtest region is the NMC
+# memory, so half of the cacheable accesses and their packets cross
+# between the threads through the EventQueueBridge.
+
+import optparse
+
+import m5
+from m5.objects import *
+m5.util.addToPath('../configs/')
+from common import MemConfig
+from common import Options
+from common.Caches import *
+
+nb_cores = 8
+cpus = [ MemTest() for i in xrange(nb_cores) ]
+
+parser = optparse.OptionParser()
+Options.addCommonOptions(parser)
+Options.addNMCCoresOptions(parser)
+(options, args) = parser.parse_args([])
+
+options.mem_type = "SimpleMemory"
+options.mem_channels = 1
+options.nmc = True
+options.nmc_mem_type = "SimpleMemory"
+options.nmc_parallel = True
+# Between the first memtest region at 0x100000 and the uncacheable one at
+# 0x800000, see memtest.cc
+options.nmc_start = "0x400000"
+options.nmc_mem_size = "4MB"
+
+# system simulated
+system = System(cpu = cpus,
+                mem_ranges = [AddrRange(0, size = '4MB'),
+                              AddrRange(0x800000, size = '4MB')],
+                membus = SystemXBar())
+# Dummy voltage domain for all our clock domains
+system.voltage_domain = VoltageDomain()
+system.clk_domain = SrcClockDomain(clock = '1GHz',
+                                   voltage_domain = system.voltage_domain)
+
+# Create a seperate clock domain for components that should run at
+# CPUs frequency
+system.cpu_clk_domain = SrcClockDomain(clock = '2GHz',
+                                       voltage_domain = system.voltage_domain)
+
+system.toL2Bus = L2XBar(clk_domain = system.cpu_clk_domain)
+system.l2c = L2Cache(clk_domain = system.cpu_clk_domain, size='64kB', assoc=8)
+system.l2c.cpu_side = system.toL2Bus.master
+
+# connect l2c to membus
+system.l2c.mem_side = system.membus.slave
+
+# add L1 caches
+for cpu in cpus:
+    # All cpus are associated with cpu_clk_domain
+    cpu.clk_domain = system.cpu_clk_domain
+    cpu.l1c = L1Cache(size = '32kB', assoc = 4)
+    cpu.l1c.cpu_side = cpu.port
+    cpu.l1c.mem_side = system.toL2Bus.slave
+
+system.system_port = system.membus.slave
+
+# the host memory and the NMC memory behind its bridge, as fs.py does
+MemConfig.config_mem(options, system)
+
+# -----------------------
+# run simulation
+# -----------------------
+
+root = Root( full_system = False, system = system )
+root.system.mem_mode = 'timing'
+
+# The threads of the CPUs and of the NMC memory meet every quantum
+m5.ticks.fixGlobalFrequency()
+root.sim_quantum = m5.ticks.fromSeconds(
+    m5.util.convert.anyToLatency(options.nmc_sim_quantum))
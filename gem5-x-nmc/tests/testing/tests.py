@@ -154,6 +154,7 @@ generic_configs = (
     'memcheck',
     'memtest',
     'memtest-filter',
+    'memtest-nmc-parallel',
     'tgen-simple-mem',
     'tgen-dram-ctrl',
     'dram-lowp',
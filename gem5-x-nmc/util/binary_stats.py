@@ -0,0 +1,140 @@
+#!/usr/bin/env python2
+
+#  /*
+#  * Copyright EPFL 2024
+#  * Rafael Medina Morillas
+#  *
+#  */
+
+# Reader of the binary stats files written with
+# --stats-file=binary://FILE, see src/base/stats/binary.hh for the
+# format.
+#
+# As a library:
+#
+#   stats = BinaryStats("m5out/stats.bin")
+#   for tick, dump in stats.dumps():
+#       print tick, dump["sim_insts"]
+#   ticks, values = stats.column("system.cpu.numCycles")
+#
+# As a script, it converts the dumps to CSV, one row per dump, with the
+# tick and the selected stats (all of them by default):
+#
+#   binary_stats.py m5out/stats.bin -s "system.cpu.*" > timeline.csv
+
+from __future__ import print_function
+
+import argparse
+import fnmatch
+import struct
+
+MAGIC = b"gem5bst\0"
+VERSION = 1
+
+class BinaryStats(object):
+    def __init__(self, filename):
+        self.filename = filename
+        with open(filename, "rb") as f:
+            self._checkHeader(f)
+
+    def _checkHeader(self, f):
+        header = f.read(len(MAGIC) + 4)
+        if len(header) != len(MAGIC) + 4 or header[:len(MAGIC)] != MAGIC:
+            raise ValueError("%s is not a binary stats file" % self.filename)
+        version, = struct.unpack("=I", header[len(MAGIC):])
+        if version != VERSION:
+            raise ValueError("%s has unsupported version %d" %
+                             (self.filename, version))
+
+    def _read(self, f, fmt):
+        size = struct.calcsize(fmt)
+        data = f.read(size)
+        if len(data) != size:
+            raise EOFError
+        return struct.unpack(fmt, data)
+
+    def records(self):
+        """Yield (tick, names, values) for each dump, where names is the
+        list of the column names and values the list of their values.
+        The lists are only valid until the next dump is read."""
+
+        with open(self.filename, "rb") as f:
+            self._checkHeader(f)
+            names = []
+            values = []
+            while True:
+                kind = f.read(1)
+                if not kind:
+                    return
+                try:
+                    if kind == b"S":
+                        count, = self._read(f, "=I")
+                        names = []
+                        for i in range(count):
+                            length, = self._read(f, "=H")
+                            name = f.read(length)
+                            if len(name) != length:
+                                raise EOFError
+                            names.append(name.decode())
+                        values = [float("nan")] * count
+                    elif kind == b"D":
+                        tick, = self._read(f, "=Q")
+                        bitmap = bytearray(f.read((len(names) + 7) // 8))
+                        if len(bitmap) != (len(names) + 7) // 8:
+                            raise EOFError
+                        changed = [i for i in range(len(names))
+                                   if bitmap[i // 8] & (1 << (i % 8))]
+                        new = self._read(f, "=%dd" % len(changed))
+                        for i, value in zip(changed, new):
+                            values[i] = value
+                        yield tick, names, values
+                    else:
+                        raise ValueError("%s: unknown record %r" %
+                                         (self.filename, kind))
+                except EOFError:
+                    # The simulation may still be writing the last dump
+                    return
+
+    def dumps(self):
+        """Yield (tick, dict of the values by name) for each dump."""
+
+        for tick, names, values in self.records():
+            yield tick, dict(zip(names, values))
+
+    def column(self, name):
+        """Return the ticks of the dumps and the values of a stat, NaN
+        in the dumps where it does not exist."""
+
+        ticks = []
+        values = []
+        schema = None
+        for tick, names, dump in self.records():
+            if names is not schema:
+                schema = names
+                index = names.index(name) if name in names else None
+            ticks.append(tick)
+            values.append(dump[index] if index is not None else float("nan"))
+        return ticks, values
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Convert a binary stats file to CSV")
+    parser.add_argument("file", help="binary stats file")
+    parser.add_argument("-s", "--stats", action="append", default=[],
+                        help="stats to output, as shell patterns "
+                        "(default: all the stats of the first dump)")
+    args = parser.parse_args()
+
+    stats = BinaryStats(args.file)
+    columns = None
+    for tick, names, values in stats.records():
+        if columns is None:
+            columns = [n for n in names if not args.stats or
+                       any(fnmatch.fnmatchcase(n, p) for p in args.stats)]
+            print(",".join(["tick"] + columns))
+        dump = dict(zip(names, values))
+        print(",".join([str(tick)] +
+                       [repr(dump.get(c, float("nan"))) for c in columns]))
+
+if __name__ == "__main__":
+    main()
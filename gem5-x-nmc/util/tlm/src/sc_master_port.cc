@@ -47,7 +47,7 @@ PacketPtr
 SCMasterPort::generatePacket(tlm::tlm_generic_payload& trans)
 {
     Request::Flags flags;
-    auto req = std::make_shared<Request>(
+    auto req = makeRequest(
         trans.get_address(), trans.get_data_length(), flags,
         owner.masterId);
 
@@ -31,9 +31,15 @@ void cnmMemoryMap(CnmElements* cnmElements) {
 #ifndef CHECKER
     cnmElements->rfAddr = memoryMap(LENGTH_MEM, RF_INST_MEM);
     cnmElements->execAddr  = memoryMap(LENGTH_MEM, EXEC_INST_MEM);
+#if CACHED_RESULTS
+    cnmElements->resAddr = memoryMap(LENGTH_MEM, EXEC_INST_MEM, true);
+#else
+    cnmElements->resAddr = cnmElements->execAddr;
+#endif
 #else
     cnmElements->rfAddr = (uint64_t*)malloc(LENGTH_MEM);
     cnmElements->execAddr = (uint64_t*)malloc(LENGTH_MEM);
+    cnmElements->resAddr = cnmElements->execAddr;
 #endif
 
 #ifdef DEBUG
@@ -47,6 +53,9 @@ void cnmMemoryUnmap(CnmElements* cnmElements) {
 #ifndef CHECKER
     memoryUnmap(cnmElements->rfAddr, LENGTH_MEM);
     memoryUnmap(cnmElements->execAddr, LENGTH_MEM);
+#if CACHED_RESULTS
+    memoryUnmap(cnmElements->resAddr, LENGTH_MEM);
+#endif
 #else
     free(cnmElements->rfAddr);
     free(cnmElements->execAddr);
@@ -303,7 +303,7 @@ void ConvolutionKernel::loadResults(uint64_t* outputData) {
     for (uint i = 0; i < co; i++) {
         for (uint j = 0; j < totalCol; j++) {
 #ifndef CHECKER
-            memcpy(outputData + (i*totalCol+j)*GRF_64B, cnmExecAddress(channel, 0, bgOutIdx, bankOutIdx, rowOutIdx, colOutIdx, cnmElements->execAddr), GRF_64B*sizeof(uint64_t));
+            readCnmResult(outputData + (i*totalCol+j)*GRF_64B, cnmExecAddress(channel, 0, bgOutIdx, bankOutIdx, rowOutIdx, colOutIdx, cnmElements->resAddr), GRF_64B*sizeof(uint64_t));
 #else
             memcpy(outputData + (i*totalCol+j)*GRF_64B, addrStart + totalColPerUnrrols*GRF_64B + (i*totalCol+j)*GRF_64B, GRF_64B*sizeof(uint64_t));
 #endif
@@ -22,8 +22,13 @@ void ldrData(uint64_t *addr, uint64_t* data) {
     std::cout << std::showbase << std::hex << addr << " RD " << *data << std::endl;
 }
 
+void cleanInvalidateData(uint64_t *addr, size_t size) {
+}
+
 #else
 
+#define CACHE_LINE_SIZE 64  // Line size of the host data caches, in bytes
+
 // Assembly intrinsics to store 64 bits of data in a memory address
 __attribute__((always_inline)) void strData(uint64_t *addr, uint64_t data){
         __asm__ volatile(
@@ -44,6 +49,22 @@ __attribute__((always_inline)) void ldrData(uint64_t *addr, uint64_t* data){
                 );		
 }
 
+// Assembly intrinsics to clean and invalidate the cache lines of a memory range, so that
+// the next loads fetch it from the memory
+__attribute__((always_inline)) void cleanInvalidateData(uint64_t *addr, size_t size){
+        uintptr_t line = (uintptr_t)addr & ~(uintptr_t)(CACHE_LINE_SIZE - 1);
+        uintptr_t end = (uintptr_t)addr + size;
+        for (; line < end; line += CACHE_LINE_SIZE) {
+                __asm__ volatile(
+                        "DC CIVAC, %[register1]\n\t"\
+                        :
+                        : [register1] "r" (line)
+                        : "memory"
+                        );
+        }
+        __asm__ volatile("DSB SY\n\t" : : : "memory");
+}
+
 #endif  // CHECKER
 
 #endif  // CNM_INTRINSICS_H
\ No newline at end of file
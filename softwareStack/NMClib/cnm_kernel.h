@@ -23,11 +23,12 @@ class Kernel;
 
 typedef struct CnmElements {
     uint64_t* execAddr;
+    uint64_t* resAddr;     // Mapping of the exec region used to read the results, cacheable with CACHED_RESULTS
     uint64_t* rfAddr;
     uint numChannels;
     std::vector<std::vector<Kernel*> > kernelList;
 
-    CnmElements(uint _numChannels) : execAddr(NULL), rfAddr(NULL), numChannels(_numChannels) {
+    CnmElements(uint _numChannels) : execAddr(NULL), resAddr(NULL), rfAddr(NULL), numChannels(_numChannels) {
         kernelList.resize(_numChannels);
     }
 } CnmElements;
@@ -181,7 +181,7 @@ void MatrixMultiplicationKernel::loadResults (uint64_t* mResData) {
     for (int i = 0; i < m; i++) {
         for (uint j = 0; j < totalCol; j++) {
 #ifndef CHECKER
-            memcpy(mResData + (i*totalCol+j)*GRF_64B, cnmExecAddress(channel, 0, bgIdx, bankIdx, rowIdx, colIdx, cnmElements->execAddr), GRF_64B*sizeof(uint64_t));
+            readCnmResult(mResData + (i*totalCol+j)*GRF_64B, cnmExecAddress(channel, 0, bgIdx, bankIdx, rowIdx, colIdx, cnmElements->resAddr), GRF_64B*sizeof(uint64_t));
 #else
             memcpy(mResData + (i*totalCol+j)*GRF_64B, addrStart + n*totalCol*GRF_64B + (i*totalCol+j)*GRF_64B, GRF_64B*sizeof(uint64_t));
 #endif
@@ -29,6 +29,14 @@
 #define RF_INST_MEM     RF_START
 #define LENGTH_MEM      (RF_INST_MEM - EXEC_INST_MEM)
 
+// 1 to read the results through a cacheable mapping of the exec region. It aliases the
+// O_SYNC mapping, so every result is cleaned and invalidated from the caches before it is
+// read (readCnmResult). The kernel has to map the region as normal memory, otherwise
+// /dev/mem gives a non-cacheable one.
+#ifndef CACHED_RESULTS
+#define CACHED_RESULTS  0
+#endif
+
 // Addresses to change between memory and PIM modes for the different channels
 #define MODE_CHANGE_START   (RF_OFFSET - 1 - ((1UL << (GLOBAL_OFFSET + CHANNEL_BITS)) - 1))
 #define MODE_CHANGE_END     (MODE_CHANGE_START + (((1UL << (CHANNEL_BITS)) - 1) << GLOBAL_OFFSET))
@@ -66,9 +74,10 @@ Level map[int(Level::MAX)] = {Level::Channel, Level::Column, Level::Rank,
 // Parameters:
 // - length: length of the memory region to map
 // - offset: physical address where the memory region should start
-uint64_t* memoryMap(uint64_t length, uint64_t offset) {
+// - cached: map the region cacheable instead of with O_SYNC
+uint64_t* memoryMap(uint64_t length, uint64_t offset, bool cached = false) {
     int fd;
-    fd = open("/dev/mem", O_RDWR | O_SYNC);
+    fd = open("/dev/mem", cached ? O_RDWR : O_RDWR | O_SYNC);
     if (fd == -1) {
         printf("ERR: cannot open /dev/mem\n");
         return (uint64_t *)-1;
@@ -112,6 +121,16 @@ inline uint64_t* cnmExecAddress(uint chIdx, uint raIdx, uint bgIdx, uint baIdx,
         ) / sizeof(uint64_t);
 }
 
+// Function to copy a result out of the exec region. With CACHED_RESULTS, the lines of the
+// result are dropped from the caches first, as the cacheable mapping can hold copies older
+// than what the CnM PUs wrote
+inline void readCnmResult(uint64_t* dest, uint64_t* src, size_t size) {
+#if CACHED_RESULTS
+    cleanInvalidateData(src, size);
+#endif
+    memcpy(dest, src, size);
+}
+
 #ifdef DEBUG
 // Function to generate the address of a memory location in the CNM DRAM memory mapped region, taking a std::vector as input
 uint64_t* cnmExecAddress(std::vector<uint> addrVec, uint64_t* offsetAddr) {
@@ -153,7 +153,7 @@ void VectorAdditionKernel::loadResults(uint64_t* resData) {
     // Store the vectors in column chunks, jumping over channel and offset bits
     for (uint i = 0; i < totalCol; i++) {
 #ifndef CHECKER
-        memcpy(resData + i*GRF_64B, cnmExecAddress(channel, 0, bgIdx, bankIdx, rowIdx, colIdx, cnmElements->execAddr), GRF_64B*sizeof(uint64_t));
+        readCnmResult(resData + i*GRF_64B, cnmExecAddress(channel, 0, bgIdx, bankIdx, rowIdx, colIdx, cnmElements->resAddr), GRF_64B*sizeof(uint64_t));
 #else
         memcpy(resData + i*GRF_64B, addrStart + 2*numVectors*vectorDims/WORDS_PER_64B + i*GRF_64B, GRF_64B*sizeof(uint64_t));
 #endif